@@ -0,0 +1,102 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+// Compares adding and removing addresses by spawning ip(8) once per address
+// with adding and removing all of them in a single rtnetlink batch. The
+// addresses are put onto one end of a veth pair.
+//
+// usage: address_benchmark [addresses]
+
+#include "ip_address.h"
+#include "log.h"
+#include "scope_guard.h"
+#include "to_string.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <span>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+/** exit code telling meson the benchmark has been skipped */
+int const exit_skip = 77;
+
+std::string const iface = "spbench0";
+std::string const peer = "spbench1";
+
+/** creates and removes the veth pair */
+std::string veth_pair(Action const action) {
+  if (action == Action::add) {
+    return "ip link add " + iface + " type veth peer name " + peer;
+  }
+  return "ip link del " + iface;
+}
+
+/** count addresses from 10.254.0.1 upwards */
+std::vector<IP_address> create_addresses(size_t const count) {
+  std::vector<IP_address> ips;
+  static auto const per_octet = size_t{250};
+  for (size_t i = 0; i < count; i++) {
+    ips.emplace_back(parse_ip("10.254." + to_string(i / per_octet) + "." +
+                              to_string(i % per_octet + 1) + "/32"));
+  }
+  return ips;
+}
+
+template <typename Function>
+void measure(std::string const &name, size_t const count, Function fun) {
+  auto const start = std::chrono::steady_clock::now();
+  fun();
+  auto const duration = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start);
+  std::cout << name << ": added and removed " << count << " addresses in "
+            << duration.count() << " us, "
+            << duration.count() / static_cast<long>(count)
+            << " us per address\n";
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::span<char *> const args{argv, static_cast<size_t>(argc)};
+  auto const count = args.size() > 1 ? std::stoul(args[1]) : size_t{100};
+  // parse_ip() and the guards log every address
+  setup_log(args[0], 0, LOG_USER);
+  auto const ips = create_addresses(count);
+
+  if (geteuid() != 0) {
+    std::cout << "skipping, creating a veth pair needs root\n";
+    return exit_skip;
+  }
+  try {
+    Scope_guard const veth{veth_pair};
+    measure("ip addr", count, [&] {
+      std::vector<Scope_guard> guards;
+      for (auto const &ip : ips) {
+        guards.emplace_back(Temp_ip{.iface = iface, .ip = ip});
+      }
+    });
+    measure("rtnetlink", count, [&] {
+      Scope_guard const guard{Temp_ips{.iface = iface, .ips = ips}};
+    });
+  } catch (std::exception const &e) {
+    std::cout << "skipping: " << e.what() << '\n';
+    return exit_skip;
+  }
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,116 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+// Measures what handing a captured packet to its handler costs. Packets are
+// replayed from memory by a Pcap_wrapper without a pcap handle, once through
+// the std::function based loop() and once through the templated one.
+//
+// usage: callback_dispatch_benchmark [million packets]
+
+#include "packet_parser.h"
+#include "pcap_wrapper.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <span>
+#include <string>
+
+namespace {
+// ethernet, 127.0.0.1:50000 -> 127.0.0.1:22, TCP SYN
+// NOLINTNEXTLINE
+std::vector<uint8_t> const syn{
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x08, 0x00, 0x45, 0x00, 0x00, 0x3c, 0x88, 0xd0, 0x40, 0x00, 0x40, 0x06,
+    0xb3, 0xe9, 0x7f, 0x00, 0x00, 0x01, 0x7f, 0x00, 0x00, 0x01, 0xc3, 0x50,
+    0x00, 0x16, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xa0, 0x02,
+    0xff, 0xd7, 0xfe, 0x30, 0x00, 0x00};
+
+/** hands the same packet count times to the callback */
+struct Replay : public Pcap_wrapper {
+protected:
+  Loop_end_reason run_loop(int const count, pcap_handler const callback,
+                           u_char *const user) override {
+    auto const size = static_cast<uint32_t>(syn.size());
+    pcap_pkthdr const header{
+        .ts = {.tv_sec = 0, .tv_usec = 0}, .caplen = size, .len = size};
+    for (int i = 0; i < count; i++) {
+      callback(user, &header, syn.data());
+    }
+    return Loop_end_reason::packets_captured;
+  }
+};
+
+template <typename Func>
+void measure(std::string const &name, int const packets, Func &&func) {
+  auto const start = std::chrono::steady_clock::now();
+  auto const result = func();
+  auto const duration = std::chrono::steady_clock::now() - start;
+  auto const ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  // NOLINTNEXTLINE
+  std::cout << name << ": " << ns * 1000 / packets
+            << " us per million packets (" << result << ")\n";
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::span<char *> const args{argv, static_cast<size_t>(argc)};
+  auto const million = args.size() > 1 ? std::stoi(args[1]) : 20;
+  // NOLINTNEXTLINE
+  int const packets = million * 1000000;
+  Replay replay;
+
+  measure("count, std::function", packets, [&] {
+    size_t counted = 0;
+    Pcap_wrapper::Callback_t const cb = [&](const pcap_pkthdr *header,
+                                            const u_char *) {
+      counted += header->len;
+    };
+    replay.loop(packets, cb);
+    return counted;
+  });
+  measure("count, template", packets, [&] {
+    size_t counted = 0;
+    replay.loop(packets, [&](const pcap_pkthdr *header, const u_char *) {
+      counted += header->len;
+    });
+    return counted;
+  });
+
+  auto const parse = [](const pcap_pkthdr *header, const u_char *packet) {
+    auto const view = to_packet_view(*header, packet);
+    auto const headers = get_headers(DLT_EN10MB, view);
+    return get_destination_port(headers, view).value_or(0);
+  };
+  measure("parse, std::function", packets, [&] {
+    size_t ports = 0;
+    Pcap_wrapper::Callback_t const cb = [&](const pcap_pkthdr *header,
+                                            const u_char *packet) {
+      ports += parse(header, packet);
+    };
+    replay.loop(packets, cb);
+    return ports;
+  });
+  measure("parse, template", packets, [&] {
+    size_t ports = 0;
+    replay.loop(packets, [&](const pcap_pkthdr *header, const u_char *packet) {
+      ports += parse(header, packet);
+    });
+    return ports;
+  });
+  return EXIT_SUCCESS;
+}
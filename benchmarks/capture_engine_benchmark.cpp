@@ -0,0 +1,181 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+// Compares CPU time and memory of one pcap handle for SYN and one for magic
+// packets per host, like emulateHost uses them, with a single Capture_engine
+// shared by all hosts. Both are fed the same UDP traffic on the loopback
+// interface, which passes the filters of every handle.
+//
+// usage: capture_engine_benchmark [hosts] [packets]
+
+#include "capture_engine.h"
+#include "ethernet.h"
+#include "libsleep_proxy.h"
+#include "log.h"
+#include "packet_parser.h"
+#include "socket.h"
+#include "wol_watcher.h"
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <netinet/in.h>
+#include <span>
+#include <sstream>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+
+namespace {
+/** exit code telling meson the benchmark has been skipped */
+int const exit_skip = 77;
+
+std::string const iface = "lo";
+
+struct Usage {
+  std::chrono::microseconds cpu;
+  long rss_kb;
+};
+
+std::chrono::microseconds to_duration(timeval const &tv) {
+  return std::chrono::seconds(tv.tv_sec) +
+         std::chrono::microseconds(tv.tv_usec);
+}
+
+Usage get_usage() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  long rss_kb = 0;
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.starts_with("VmRSS:")) {
+      rss_kb = std::stol(line.substr(line.find_first_of("0123456789")));
+    }
+  }
+  return {.cpu = to_duration(usage.ru_utime) + to_duration(usage.ru_stime),
+          .rss_kb = rss_kb};
+}
+
+std::vector<Host_args> create_hosts(size_t const count) {
+  std::vector<Host_args> hosts;
+  for (size_t i = 0; i < count; i++) {
+    // 10.0.x.y, none of them receives traffic
+    auto const ip = "10.0." + to_string(i / 250) + "." + to_string(i % 250 + 1);
+    std::ostringstream mac;
+    // NOLINTNEXTLINE
+    mac << std::hex << "02:00:00:00:" << (i >> 8U & 0xffU) << ':'
+        << (i & 0xffU);
+    hosts.emplace_back(iface, std::vector<IP_address>{parse_ip(ip + "/32")},
+                       std::vector<uint16_t>{22, 80},
+                       mac_to_binary(mac.str()),
+                       "host" + to_string(i), 1, Wol_method::ethernet);
+  }
+  return hosts;
+}
+
+/** sends packets to the discard port of localhost, matching the WOL filter */
+void send_traffic(size_t const packets) {
+  Socket sock(AF_INET, SOCK_DGRAM);
+  sockaddr_in addr{};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(9);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  // NOLINTNEXTLINE
+  std::vector<uint8_t> const payload(200, 0xab);
+  for (size_t i = 0; i < packets; i++) {
+    sock.send_to(payload, 0, addr);
+  }
+  // give the captures time to process the tail of the traffic
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+}
+
+void report(std::string const &name, size_t const hosts, Usage const &start,
+            Usage const &opened, Usage const &end) {
+  std::cout << name << ": hosts " << hosts << ", rss after open "
+            << opened.rss_kb - start.rss_kb << " kB, cpu while capturing "
+            << (end.cpu - opened.cpu).count() << " us\n";
+}
+
+/** two handles per host, like emulate_host() with Wol_watcher */
+void per_host_handles(std::vector<Host_args> const &hosts,
+                      size_t const packets) {
+  auto const start = get_usage();
+  std::vector<std::unique_ptr<Pcap_wrapper>> pcaps;
+  for (auto const &host : hosts) {
+    pcaps.emplace_back(std::make_unique<Pcap_wrapper>(iface));
+    pcaps.back()->set_filter(
+        rule_to_listen_on_ips_and_ports(host.address, host.ports));
+    pcaps.emplace_back(std::make_unique<Pcap_wrapper>(iface));
+    pcaps.back()->set_filter(
+        get_wol_filter({host.mac}, pcaps.back()->get_datalink()));
+  }
+  std::vector<std::thread> threads;
+  for (auto &pc : pcaps) {
+    threads.emplace_back([&pc, mac = hosts.front().mac] {
+      pc->loop(0, [&mac](const pcap_pkthdr *header, const u_char *packet) {
+        // do the same work as Wol_watcher
+        static_cast<void>(
+            is_magic_packet(to_packet_view(*header, packet), mac));
+      });
+    });
+  }
+  auto const opened = get_usage();
+  send_traffic(packets);
+  auto const end = get_usage();
+  for (auto &pc : pcaps) {
+    pc->break_loop(Pcap_wrapper::Loop_end_reason::signal);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  report("per host handles", hosts.size(), start, opened, end);
+}
+
+void shared_engine(std::vector<Host_args> const &hosts, size_t const packets) {
+  auto const start = get_usage();
+  Capture_engine engine{iface, hosts};
+  auto const opened = get_usage();
+  send_traffic(packets);
+  auto const end = get_usage();
+  engine.stop();
+  report("capture engine", hosts.size(), start, opened, end);
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::span<char *> const args{argv, static_cast<size_t>(argc)};
+  auto const host_count =
+      args.size() > 1 ? std::stoul(args[1]) : size_t{60};
+  auto const packets = args.size() > 2 ? std::stoul(args[2]) : size_t{20000};
+  setup_log(args[0], 0, LOG_USER);
+  setlogmask(LOG_UPTO(LOG_ERR));
+
+  auto const hosts = create_hosts(host_count);
+  try {
+    // make sure capturing is possible at all
+    Pcap_wrapper const probe{iface};
+  } catch (std::exception const &e) {
+    std::cout << "skipping, can't capture on " << iface << ": " << e.what()
+              << '\n';
+    return exit_skip;
+  }
+  shared_engine(hosts, packets);
+  per_host_handles(hosts, packets);
+  return EXIT_SUCCESS;
+}
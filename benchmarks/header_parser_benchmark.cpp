@@ -0,0 +1,94 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+// Compares get_headers(), which looks at the datalink of every packet, with
+// the Header_parser picked once per capture by with_header_parser().
+//
+// usage: header_parser_benchmark [packets]
+
+#include "container_utils.h"
+#include "ethernet.h"
+#include "packet_parser.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <span>
+#include <string>
+
+namespace {
+/** ethernet, IPv4 and TCP SYN from 10.0.0.1:50000 to 10.0.0.2:22 */
+std::vector<uint8_t> create_ethernet_frame() {
+  auto const mac = mac_to_binary("02:00:00:00:00:01");
+  // version/ihl, tos, length 40, id, flags, ttl, tcp, checksum
+  std::vector<uint8_t> const ip_tcp{
+      0x45, 0, 0, 40, 0, 0, 0, 0, 64, 6, 0, 0, 10, 0, 0, 1, 10, 0, 0, 2,
+      // ports, seq, ack, offset, SYN, window, checksum, urgent pointer
+      0xc3, 0x50, 0, 22, 0, 0, 0, 0, 0, 0, 0, 0, 0x50, 0x02, 0xff, 0xff, 0, 0,
+      0, 0};
+  return create_ethernet_header(mac, mac, ETHERTYPE_IP) + ip_tcp;
+}
+
+/** the same packet captured on the any device */
+std::vector<uint8_t> create_lcc_frame(std::vector<uint8_t> const &ethernet) {
+  // incoming, ARPHRD_ETHER, mac, ETHERTYPE_IP
+  std::vector<uint8_t> lcc{0, 0, 0, 1, 0, 6, 2, 0, 0, 0, 0, 1, 0, 0, 8, 0};
+  lcc.insert(std::end(lcc),
+             std::begin(ethernet) + Link_layer::ethernet_header_size,
+             std::end(ethernet));
+  return lcc;
+}
+
+template <typename Parser>
+void measure(std::string const &name, std::vector<uint8_t> const &frame,
+             size_t const packets, Parser &&parser) {
+  size_t header_bytes = 0;
+  auto const start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < packets; i++) {
+    auto const headers = parser(Packet_view{frame});
+    header_bytes += std::get<0>(headers)->header_length() +
+                    std::get<1>(headers)->header_length();
+  }
+  auto const duration = std::chrono::steady_clock::now() - start;
+  auto const ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  std::cout << "  " << name << ": " << ns / static_cast<long>(packets)
+            << " ns per packet, " << header_bytes / packets
+            << " header bytes\n";
+}
+
+void run(std::string const &name, int const datalink,
+         std::vector<uint8_t> const &frame, size_t const packets) {
+  std::cout << name << '\n';
+  measure("get_headers", frame, packets, [datalink](Packet_view const packet) {
+    return get_headers(datalink, packet);
+  });
+  with_header_parser(datalink, [&](auto const parser) {
+    measure("Header_parser", frame, packets, parser);
+  });
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::span<char *> const args{argv, static_cast<size_t>(argc)};
+  auto const packets = args.size() > 1 ? std::stoul(args[1]) : size_t{1000000};
+
+  auto const ethernet = create_ethernet_frame();
+  run("ethernet", DLT_EN10MB, ethernet, packets);
+  run("linux cooked capture", DLT_LINUX_SLL, create_lcc_frame(ethernet),
+      packets);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,107 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+// Compares the binary comparison and hashing of IP_address with the string
+// based comparison used before and with a lookup table keyed by the
+// formatted addresses, as Host_lookup had.
+//
+// usage: ip_address_benchmark [addresses] [rounds]
+
+#include "ip_address.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+/** half IPv4, half IPv6 */
+std::vector<IP_address> create_addresses(size_t const count) {
+  std::vector<IP_address> addresses;
+  for (size_t i = 0; i < count; i++) {
+    // NOLINTNEXTLINE
+    auto const low = std::to_string(i & 0xffU);
+    // NOLINTNEXTLINE
+    auto const high = std::to_string(i >> 8U & 0xffU);
+    addresses.push_back(i % 2 == 0 ? parse_ip("10.0." + high + "." + low)
+                                   : parse_ip("2001:db8::" + high + ":" + low));
+  }
+  return addresses;
+}
+
+template <typename Func>
+void measure(std::string const &name, std::vector<IP_address> const &addresses,
+             size_t const rounds, Func &&func) {
+  size_t result = 0;
+  auto const start = std::chrono::steady_clock::now();
+  for (size_t round = 0; round < rounds; round++) {
+    for (auto const &address : addresses) {
+      result += func(address);
+    }
+  }
+  auto const duration = std::chrono::steady_clock::now() - start;
+  auto const ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  std::cout << name << ": "
+            << ns / static_cast<long>(rounds * addresses.size())
+            << " ns per address, result " << result << '\n';
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::span<char *> const args{argv, static_cast<size_t>(argc)};
+  auto const count = args.size() > 1 ? std::stoul(args[1]) : size_t{64};
+  auto const rounds = args.size() > 2 ? std::stoul(args[2]) : size_t{20000};
+
+  auto const addresses = create_addresses(count);
+  auto const &needle = addresses.back();
+
+  measure("equality by string", addresses, rounds,
+          [&](IP_address const &address) {
+            return static_cast<size_t>(address.family == needle.family &&
+                                       address.subnet == needle.subnet &&
+                                       address.pure() == needle.pure());
+          });
+  measure("equality", addresses, rounds, [&](IP_address const &address) {
+    return static_cast<size_t>(address == needle);
+  });
+
+  measure("hash of string", addresses, rounds,
+          [](IP_address const &address) {
+            return std::hash<std::string>{}(address.pure());
+          });
+  measure("hash", addresses, rounds, [](IP_address const &address) {
+    return std::hash<IP_address>{}(address);
+  });
+
+  std::unordered_map<std::string, size_t> by_string;
+  std::unordered_map<IP_address, size_t> by_address;
+  for (size_t i = 0; i < addresses.size(); i += 2) {
+    by_string.emplace(addresses.at(i).pure(), i);
+    by_address.emplace(addresses.at(i), i);
+  }
+  measure("lookup by string", addresses, rounds,
+          [&](IP_address const &address) {
+            return by_string.count(address.pure());
+          });
+  measure("lookup", addresses, rounds, [&](IP_address const &address) {
+    return by_address.count(address);
+  });
+  return EXIT_SUCCESS;
+}
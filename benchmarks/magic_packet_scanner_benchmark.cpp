@@ -0,0 +1,123 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+// Measures how fast magic packets for many hosts are found. The search for a
+// single mac with std::ranges::search, once per host, is compared with
+// Magic_packet_scanner on each instruction set. The miss case uses frames
+// without any magic packet, the hit case puts one for the last host at the
+// end of each frame.
+//
+// usage: magic_packet_scanner_benchmark [hosts] [packets]
+
+#include "ethernet.h"
+#include "magic_packet_scanner.h"
+#include "wol.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <span>
+#include <sstream>
+#include <string>
+
+namespace {
+/** size of a full ethernet frame */
+auto const frame_size = size_t{1500};
+
+std::vector<ether_addr> create_macs(size_t const count) {
+  std::vector<ether_addr> macs;
+  for (size_t i = 0; i < count; i++) {
+    std::ostringstream mac;
+    // NOLINTNEXTLINE
+    mac << std::hex << "02:00:00:00:" << (i >> 8U & 0xffU) << ':'
+        << (i & 0xffU);
+    macs.emplace_back(mac_to_binary(mac.str()));
+  }
+  return macs;
+}
+
+std::vector<uint8_t> create_frame(std::default_random_engine &generator) {
+  // NOLINTNEXTLINE
+  std::uniform_int_distribution<int> distribution(0, 0xfe);
+  std::vector<uint8_t> frame(frame_size);
+  for (auto &byte : frame) {
+    byte = static_cast<uint8_t>(distribution(generator));
+  }
+  return frame;
+}
+
+/** what Wol_watcher did for each of its hosts */
+bool search_for_mac(Packet_view const data, ether_addr const &mac) {
+  std::vector<uint8_t> const pattern{create_wol_payload(mac)};
+  return !std::ranges::search(data, pattern).empty();
+}
+
+template <typename Func>
+void measure(std::string const &name, std::vector<uint8_t> const &frame,
+             size_t const packets, Func &&func) {
+  size_t found = 0;
+  auto const start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < packets; i++) {
+    if (func(Packet_view{frame})) {
+      found++;
+    }
+  }
+  auto const duration = std::chrono::steady_clock::now() - start;
+  auto const ns =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+  std::cout << name << ": " << ns / static_cast<long>(packets)
+            << " ns per packet, " << found << " magic packets\n";
+}
+
+void run(std::string const &name, std::vector<ether_addr> const &macs,
+         std::vector<uint8_t> const &frame, size_t const packets) {
+  std::cout << name << ", " << macs.size() << " hosts\n";
+  measure("  search per host", frame, packets, [&](Packet_view const data) {
+    return std::ranges::any_of(macs, [&](ether_addr const &mac) {
+      return search_for_mac(data, mac);
+    });
+  });
+  for (auto const level :
+       {Simd_level::scalar, Simd_level::sse2, Simd_level::avx2}) {
+    if (level > best_simd_level()) {
+      continue;
+    }
+    Magic_packet_scanner const scanner{macs, level};
+    measure("  scanner level " + std::to_string(static_cast<int>(level)),
+            frame, packets, [&](Packet_view const data) {
+              return scanner(data).has_value();
+            });
+  }
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::span<char *> const args{argv, static_cast<size_t>(argc)};
+  auto const host_count = args.size() > 1 ? std::stoul(args[1]) : size_t{60};
+  auto const packets = args.size() > 2 ? std::stoul(args[2]) : size_t{20000};
+
+  auto const macs = create_macs(host_count);
+  std::default_random_engine generator;
+  auto const miss = create_frame(generator);
+  auto hit = create_frame(generator);
+  auto const payload = create_wol_payload(macs.back());
+  std::ranges::copy(payload, std::end(hit) - std::ssize(payload));
+
+  run("miss", macs, miss, packets);
+  run("hit", macs, hit, packets);
+  return EXIT_SUCCESS;
+}
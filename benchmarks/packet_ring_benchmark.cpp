@@ -0,0 +1,162 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+// Compares the throughput of the libpcap and the TPACKET_V3 ring backend of
+// Pcap_wrapper. Frames are sent into one end of a veth pair as fast as
+// possible and captured on the other end.
+//
+// usage: packet_ring_benchmark [packets] [block size] [block count]
+//                              [block timeout in ms]
+
+#include "container_utils.h"
+#include "ethernet.h"
+#include "log.h"
+#include "pcap_wrapper.h"
+#include "scope_guard.h"
+#include "socket.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <linux/if_packet.h>
+#include <span>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+/** exit code telling meson the benchmark has been skipped */
+int const exit_skip = 77;
+
+std::string const tx_iface = "spbench0";
+std::string const rx_iface = "spbench1";
+
+/** creates and removes the veth pair */
+std::string veth_pair(Action const action) {
+  if (action == Action::add) {
+    return "ip link add " + tx_iface + " type veth peer name " + rx_iface;
+  }
+  return "ip link del " + tx_iface;
+}
+
+std::string link_up(std::string const &iface, Action const action) {
+  return "ip link set " + iface + (action == Action::add ? " up" : " down");
+}
+
+std::chrono::microseconds get_cpu_time() {
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+         std::chrono::microseconds(usage.ru_utime.tv_usec +
+                                   usage.ru_stime.tv_usec);
+}
+
+/** ethernet, IPv4 and UDP header to the discard port, some payload */
+std::vector<uint8_t> create_frame(ether_addr const &src) {
+  auto const broadcast = mac_to_binary("ff:ff:ff:ff:ff:ff");
+  // version/ihl, tos, length 128, id, flags, ttl, udp, checksum,
+  // 10.255.0.1 -> 10.255.0.2
+  std::vector<uint8_t> const ip_udp{
+      0x45, 0, 0, 128, 0, 0, 0, 0, 64, 17, 0, 0, 10, 255, 0, 1, 10, 255, 0, 2,
+      // ports 50000 -> 9, length 108, no checksum
+      0xc3, 0x50, 0, 9, 0, 108, 0, 0};
+  // NOLINTNEXTLINE
+  std::vector<uint8_t> const payload(100, 0xab);
+  return create_ethernet_header(broadcast, src, ETHERTYPE_IP) + ip_udp +
+         payload;
+}
+
+void send_frames(size_t const packets) {
+  Socket sock(AF_PACKET, SOCK_RAW, 0);
+  sockaddr_ll addr{.sll_family = AF_PACKET,
+                   .sll_protocol = 0,
+                   .sll_ifindex = sock.get_ifindex(tx_iface),
+                   .sll_hatype = 0,
+                   .sll_pkttype = 0,
+                   .sll_halen = ETH_ALEN,
+                   .sll_addr = {}};
+  auto const frame = create_frame(sock.get_hwaddr(tx_iface));
+  for (size_t i = 0; i < packets; i++) {
+    sock.send_to(frame, 0, addr);
+  }
+}
+
+void run(std::string const &name, Pcap_wrapper &pc, size_t const packets) {
+  pc.set_filter("udp port 9");
+  size_t received = 0;
+  std::thread capture{[&] {
+    pc.loop(0, [&received](const pcap_pkthdr *, const u_char *) {
+      received++;
+    });
+  }};
+  // let the capture start
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  auto const cpu_start = get_cpu_time();
+  auto const start = std::chrono::steady_clock::now();
+  send_frames(packets);
+  // allow the capture to catch up
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  pc.break_loop(Pcap_wrapper::Loop_end_reason::signal);
+  capture.join();
+  auto const duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start);
+  auto const cpu = get_cpu_time() - cpu_start;
+  std::cout << name << ": received " << received << " of " << packets
+            << " packets in " << duration.count() << " ms, cpu "
+            << cpu.count() << " us, "
+            << (received == 0 ? 0 : cpu.count() * 1000 /
+                                        static_cast<long>(received))
+            << " ns per packet\n";
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+  std::span<char *> const args{argv, static_cast<size_t>(argc)};
+  auto const packets = args.size() > 1 ? std::stoul(args[1]) : size_t{500000};
+  Ring_config config{};
+  if (args.size() > 2) {
+    config.block_size = static_cast<uint32_t>(std::stoul(args[2]));
+  }
+  if (args.size() > 3) {
+    config.block_count = static_cast<uint32_t>(std::stoul(args[3]));
+  }
+  if (args.size() > 4) {
+    config.block_timeout = static_cast<uint32_t>(std::stoul(args[4]));
+  }
+  setup_log(args[0], 0, LOG_USER);
+
+  if (geteuid() != 0) {
+    std::cout << "skipping, creating a veth pair needs root\n";
+    return exit_skip;
+  }
+  try {
+    Scope_guard const veth{veth_pair};
+    Scope_guard const tx_up{
+        [](Action const action) { return link_up(tx_iface, action); }};
+    Scope_guard const rx_up{
+        [](Action const action) { return link_up(rx_iface, action); }};
+
+    Pcap_wrapper libpcap{rx_iface};
+    run("libpcap", libpcap, packets);
+    Pcap_wrapper ring{rx_iface, config};
+    run("TPACKET_V3 ring", ring, packets);
+  } catch (std::exception const &e) {
+    std::cout << "skipping: " << e.what() << '\n';
+    return exit_skip;
+  }
+  return EXIT_SUCCESS;
+}
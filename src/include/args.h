@@ -17,6 +17,7 @@
 #pragma once
 
 #include "ip_address.h"
+#include "scope_guard.h"
 #include "wol.h"
 #include <cstdint>
 #include <netinet/ether.h>
@@ -42,16 +43,19 @@ struct Host_args {
   std::string hostname{};
   unsigned int ping_tries{};
   Wol_method wol_method{};
+  Firewall_backend firewall{};
 
   Host_args() = default;
 
   Host_args(std::string interface_, std::vector<IP_address> address_,
             std::vector<uint16_t> ports_, ether_addr mac_,
             std::string hostname_, unsigned int ping_tries_,
-            Wol_method wol_method_)
+            Wol_method wol_method_,
+            Firewall_backend firewall_ = Firewall_backend::iptables)
       : interface{std::move(interface_)}, address{std::move(address_)},
         ports{std::move(ports_)}, mac{mac_}, hostname{std::move(hostname_)},
-        ping_tries{ping_tries_}, wol_method{wol_method_} {}
+        ping_tries{ping_tries_}, wol_method{wol_method_}, firewall{firewall_} {
+  }
 };
 
 struct Args {
@@ -64,7 +68,8 @@ parse_host_args(const std::string &interface_,
                 const std::vector<std::string> &addresss_,
                 const std::vector<std::string> &ports_, const std::string &mac_,
                 const std::string &hostname_, const std::string &ping_tries_,
-                const std::string &wol_method_);
+                const std::string &wol_method_,
+                const std::string &firewall_ = "iptables");
 
 [[nodiscard]] Args read_commandline(std::span<char *> const &args);
 
@@ -0,0 +1,158 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include "args.h"
+#include "container_utils.h"
+#include "magic_packet_scanner.h"
+#include "packet_parser.h"
+#include "pcap_wrapper.h"
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Per host view of a Capture_engine. Behaves like a Pcap_wrapper towards
+ * emulate_host(), but receives its packets from the engine instead of using
+ * an own pcap handle.
+ */
+struct Host_capture : public Pcap_wrapper {
+private:
+  int const datalink;
+  std::mutex mutex{};
+  std::condition_variable stopped{};
+  /** handler of the running loop() */
+  pcap_handler callback{nullptr};
+  u_char *user{nullptr};
+  int remaining{0};
+  bool listening{false};
+  Loop_end_reason reason{Loop_end_reason::unset};
+  /** break_loop() called while not listening, consumed by the next loop() */
+  std::optional<Loop_end_reason> pending_break{};
+
+public:
+  explicit Host_capture(int datalinkk);
+
+  Host_capture(Host_capture const &) = delete;
+  Host_capture(Host_capture &&) = delete;
+
+  ~Host_capture() override;
+
+  Host_capture &operator=(Host_capture const &) = delete;
+  Host_capture &operator=(Host_capture &&) = delete;
+
+  [[nodiscard]] int get_datalink() const override;
+
+protected:
+  /** waits until the engine delivered count packets or break_loop() */
+  Pcap_wrapper::Loop_end_reason run_loop(int count, pcap_handler callbackk,
+                                         u_char *userr) override;
+
+public:
+  void break_loop(const Loop_end_reason &ler) override;
+
+  /** forget about breaks requested before the next call to loop() */
+  void reset();
+
+  [[nodiscard]] bool is_listening();
+
+  /**
+   * hands a packet to the callback of the running loop(). returns false if
+   * loop() is not running
+   */
+  bool deliver(const pcap_pkthdr *header, const u_char *packet);
+};
+
+/** what the shared capture found out about a single packet */
+struct Demux_result {
+  enum class Kind : std::uint8_t { none, syn, magic_packet, address_claim };
+  Kind kind;
+  size_t host;
+};
+
+/** lookup tables to find out to which host a captured packet belongs */
+struct Host_lookup {
+  /** destination address -> index of host in the configuration */
+  std::unordered_map<IP_address, size_t> by_address;
+  /** ports of each host */
+  std::vector<std::vector<uint16_t>> ports;
+  /** finds magic packets for the macs of all hosts */
+  Magic_packet_scanner magic_packets;
+
+  explicit Host_lookup(std::vector<Host_args> const &hosts);
+
+  [[nodiscard]] Demux_result
+  operator()(int datalink, Packet_view packet) const;
+
+  /** parses packet with a Header_parser of the datalink of the capture */
+  template <typename Parser>
+  [[nodiscard]] Demux_result operator()(Parser const &parser,
+                                        Packet_view const packet) const {
+    return demux(parser(packet), packet);
+  }
+
+  [[nodiscard]] Demux_result demux(basic_headers const &headers,
+                                   Packet_view packet) const;
+};
+
+/**
+ * a filter capturing the SYN packets, the magic packets and the address claims
+ * of other nodes for all hosts on a capture with the given datalink
+ */
+[[nodiscard]] std::string
+rule_to_listen_on_hosts(std::vector<Host_args> const &hosts, int datalink);
+
+/**
+ * Owns a single pcap handle on an interface and distributes the SYN and magic
+ * packets and address claims captured for all configured hosts to their
+ * Host_capture
+ */
+struct Capture_engine {
+private:
+  Pcap_wrapper pc;
+  Host_lookup const lookup;
+  std::vector<std::unique_ptr<Host_capture>> captures;
+  std::thread capture_thread;
+
+  template <typename Parser>
+  void dispatch(Parser const &parser, const pcap_pkthdr *header,
+                const u_char *packet);
+
+  void thread_main();
+
+public:
+  Capture_engine(std::string const &iface, std::vector<Host_args> const &hosts);
+
+  Capture_engine(Capture_engine const &) = delete;
+  Capture_engine(Capture_engine &&) = delete;
+
+  ~Capture_engine();
+
+  Capture_engine &operator=(Capture_engine const &) = delete;
+  Capture_engine &operator=(Capture_engine &&) = delete;
+
+  /** capture of the host at position index in the given hosts */
+  [[nodiscard]] Host_capture &host_capture(size_t index);
+
+  void stop();
+};
@@ -19,11 +19,15 @@
 #include <algorithm>
 #include <cstdint>
 #include <iterator>
+#include <span>
 #include <sstream>
 #include <stdexcept>
 #include <string>
 #include <vector>
 
+/** non owning view of captured or to be parsed packet data */
+using Packet_view = std::span<uint8_t const>;
+
 template <typename T> [[nodiscard]] T identity(const T &t) { return t; }
 
 template <typename Container, typename Func>
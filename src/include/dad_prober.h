@@ -0,0 +1,184 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include "container_utils.h"
+#include "ip_address.h"
+#include "packet_parser.h"
+#include "poller.h"
+#include "socket.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <netinet/ether.h>
+#include <optional>
+#include <queue>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/** a node answering for an address */
+struct Neighbor {
+  IP_address ip;
+  ether_addr mac;
+};
+
+/**
+ * ARP probe from mac asking who has ip. Like arping -D the sender address is
+ * 0.0.0.0, so that no neighbor caches are changed
+ */
+[[nodiscard]] std::vector<uint8_t> create_arp_probe(ether_addr const &mac,
+                                                    IP_address const &ip);
+
+/** sender of an ARP reply without the ethernet header */
+[[nodiscard]] std::optional<Neighbor>
+parse_arp_reply(std::span<uint8_t const> data);
+
+/**
+ * sender of an ARP request or reply without the ethernet header. nullopt for
+ * probes, which do not claim an address
+ */
+[[nodiscard]] std::optional<Neighbor>
+parse_arp_sender(std::span<uint8_t const> data);
+
+/**
+ * Neighbor Solicitation for ip with mac as source link-layer address. The
+ * kernel computes the checksum
+ */
+[[nodiscard]] std::vector<uint8_t>
+create_neighbor_solicitation(ether_addr const &mac, IP_address const &ip);
+
+/**
+ * target of a Neighbor Advertisement and its target link-layer address.
+ * The mac is all zeros if the option is missing
+ */
+[[nodiscard]] std::optional<Neighbor>
+parse_neighbor_advertisement(std::span<uint8_t const> data);
+
+/**
+ * node claiming an address with the captured ARP packet or Neighbor
+ * Advertisement packet, which headers have been parsed from
+ */
+[[nodiscard]] std::optional<Neighbor>
+get_address_claim(basic_headers const &headers, Packet_view packet);
+
+/** multicast address Neighbor Solicitations for ip are sent to */
+[[nodiscard]] IP_address get_solicited_node_address(IP_address const &ip);
+
+/** non blocking packet socket sending and receiving ARP on all interfaces */
+struct Arp_socket : public Socket {
+  Arp_socket();
+
+  using Socket::fd;
+
+  void send_probe(int ifindex, ether_addr const &mac, IP_address const &ip);
+
+  /**
+   * reads a single packet. returns nullopt if nothing was queued or the
+   * packet was no ARP reply
+   */
+  [[nodiscard]] std::optional<Neighbor> receive_reply();
+};
+
+/** non blocking raw ICMPv6 socket receiving only Neighbor Advertisements */
+struct Ndp_socket : public Socket {
+  Ndp_socket();
+
+  using Socket::fd;
+
+  void send_solicitation(int ifindex, ether_addr const &mac,
+                         IP_address const &ip);
+
+  /**
+   * reads a single packet. returns nullopt if nothing was queued or the
+   * packet was no Neighbor Advertisement
+   */
+  [[nodiscard]] std::optional<Neighbor> receive_advertisement();
+};
+
+/**
+ * Finds out whether another node uses an address by sending ARP probes and
+ * Neighbor Solicitations, instead of spawning arping and ndisc6 for each
+ * check. Replies are matched with the probes by the address they announce.
+ * A single thread waits for the replies and the timeouts of all probes.
+ */
+struct Dad_prober {
+  /** how long arping and ndisc6 wait for a reply */
+  constexpr static auto default_timeout = std::chrono::milliseconds{1000};
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Request {
+    IP_address ip;
+    /** replies from this mac are our own */
+    ether_addr own_mac;
+    Clock::time_point deadline;
+    std::promise<bool> occupied;
+  };
+
+  using Deadline = std::pair<Clock::time_point, uint64_t>;
+
+  Arp_socket arp;
+  Ndp_socket ndp;
+  Poller poller;
+  std::mutex mutex;
+  uint64_t next_id;
+  std::unordered_map<uint64_t, Request> pending;
+  /** earliest deadline first, answered requests are skipped */
+  std::priority_queue<Deadline, std::vector<Deadline>, std::greater<>>
+      deadlines;
+  std::atomic<bool> running;
+  std::thread thread;
+
+  /** answers all requests for the address of neighbor with true */
+  void answer(std::optional<Neighbor> const &neighbor);
+
+  /**
+   * answers all requests past their deadline with false. returns the ms until
+   * the next deadline, -1 if there is none
+   */
+  int expire();
+
+  void thread_main();
+
+public:
+  Dad_prober();
+
+  Dad_prober(Dad_prober const &) = delete;
+  Dad_prober(Dad_prober &&) = delete;
+
+  ~Dad_prober();
+
+  Dad_prober &operator=(Dad_prober const &) = delete;
+  Dad_prober &operator=(Dad_prober &&) = delete;
+
+  /**
+   * asks on iface who has ip. the future becomes true when a node with
+   * another mac than own_mac answers and false after timeout
+   */
+  [[nodiscard]] std::future<bool>
+  probe(std::string const &iface, IP_address const &ip,
+        ether_addr const &own_mac,
+        std::chrono::milliseconds timeout = default_timeout);
+};
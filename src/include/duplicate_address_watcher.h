@@ -16,25 +16,32 @@
 
 #pragma once
 
+#include "dad_prober.h"
 #include "ip_address.h"
+#include "neighbor_watcher.h"
 #include "pcap_wrapper.h"
 #include "scope_guard.h"
 #include <atomic>
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <thread>
 
+/** duplicate address checks of all hosts of this process share this prober */
+[[nodiscard]] Dad_prober &get_dad_prober();
+
+/** all hosts of this process share the subscription to neighbor changes */
+[[nodiscard]] Neighbor_watcher &get_neighbor_watcher();
+
 [[nodiscard]] std::string get_mac(std::string const &iface);
 
 using Is_ip_occupied =
     std::function<bool(std::string const &, IP_address const &)>;
 
-[[nodiscard]] bool
-contains_mac_different_from_given(std::string mac,
-                                  std::vector<std::string> const &lines);
-
-void daw_thread_main_ipv6(const std::string &iface, const IP_address &ip,
-                          Is_ip_occupied const &is_ip_occupied,
-                          std::atomic_bool &loop, Pcap_wrapper &pc);
+void daw_thread_main_ipv6(
+    const std::string &iface, const IP_address &ip,
+    Is_ip_occupied const &is_ip_occupied, std::atomic_bool &loop,
+    Pcap_wrapper &pc, Firewall_backend firewall = Firewall_backend::iptables);
 
 void daw_thread_main_non_root(const std::string &iface, const IP_address &ip,
                               Is_ip_occupied const &is_ip_occupied,
@@ -45,29 +52,36 @@ struct Ip_neigh_checker {
 
   explicit Ip_neigh_checker(std::string mac);
 
-  [[nodiscard]] static bool is_ipv4_present(std::string const &iface,
-                                            IP_address const &ip);
-
-  [[nodiscard]] bool is_ipv6_present(std::string const &iface,
-                                     IP_address const &ip) const;
-
   [[nodiscard]] bool operator()(std::string const &iface,
                                 IP_address const &ip) const;
 };
 
+/**
+ * Ends the capture of pcap as soon as another node uses ip. Reacts to the
+ * neighbors the kernel learns about, while probing with is_ip_occupied only
+ * serves as a slow backstop. The capture itself sees the ARP packets and
+ * Neighbor Advertisements of other nodes, see
+ * rule_to_listen_on_address_claims()
+ */
 struct Duplicate_address_watcher {
   const std::string iface;
   const IP_address ip;
   Pcap_wrapper &pcap;
   const Is_ip_occupied is_ip_occupied;
+  const Firewall_backend firewall;
   std::thread watcher;
   std::atomic<bool> loop;
+  /** id of the watch with get_neighbor_watcher() */
+  std::optional<uint64_t> neighbor_watch;
 
-  Duplicate_address_watcher(std::string ifacee, IP_address ipp,
-                            Pcap_wrapper &pc);
+  Duplicate_address_watcher(
+      std::string ifacee, IP_address ipp, Pcap_wrapper &pc,
+      Firewall_backend firewalll = Firewall_backend::iptables);
 
-  Duplicate_address_watcher(std::string ifacee, IP_address ipp,
-                            Pcap_wrapper &pc, Is_ip_occupied is_ip_occupiedd);
+  Duplicate_address_watcher(
+      std::string ifacee, IP_address ipp, Pcap_wrapper &pc,
+      Is_ip_occupied is_ip_occupiedd,
+      Firewall_backend firewalll = Firewall_backend::iptables);
 
   ~Duplicate_address_watcher();
 
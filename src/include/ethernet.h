@@ -21,8 +21,8 @@
 #include <arpa/inet.h>
 #include <array>
 #include <cstdint>
-#include <memory>
 #include <netinet/ether.h>
+#include <optional>
 #include <ostream>
 #include <pcap/bpf.h>
 #include <sys/types.h> // needed by bpf.h after openwrt 15.05+
@@ -30,22 +30,31 @@
 
 struct Link_layer {
   static auto const lcc_header_size = uint8_t{16};
+  static auto const lcc2_header_size = uint8_t{20};
   static auto const lcc_address_size = uint8_t{8};
   static auto const ethernet_header_size = uint8_t{14};
+  static auto const vlan_header_size = uint8_t{4};
   static auto const ETHERTYPE_WAKE_ON_LAN = uint16_t{0x0842};
 
+  enum class Type : std::uint8_t { ethernet, linux_cooked_capture, vlan };
+
+  Type m_type;
   size_t m_header_length;
   ether_addr m_source;
+  /** only known for ethernet */
+  ether_addr m_destination;
   uint16_t m_payload_protocol;
-  std::string m_info;
 
-  Link_layer(size_t header_length, ether_addr source, uint16_t payload_protocol,
-             std::string info);
+  Link_layer(Type type, size_t header_length, ether_addr source,
+             uint16_t payload_protocol, ether_addr destination = {});
+
+  [[nodiscard]] Type type() const;
 
   [[nodiscard]] size_t header_length() const;
 
   [[nodiscard]] uint16_t payload_protocol() const;
 
+  /** human readable description, only created when asked for */
   [[nodiscard]] std::string get_info() const;
 
   [[nodiscard]] ether_addr source() const;
@@ -64,7 +73,7 @@ create_ethernet_header(const ether_addr &dmac, const ether_addr &smac,
 [[nodiscard]] std::string binary_to_mac(const ether_addr &mac);
 
 template <typename iterator>
-[[nodiscard]] std::unique_ptr<Link_layer>
+[[nodiscard]] std::optional<Link_layer>
 parse_linux_cooked_capture(iterator data, iterator end) {
   // see https://www.tcpdump.org/linktypes/LINKTYPE_LINUX_SLL.html
   check_type_and_range(data, end, Link_layer::lcc_header_size);
@@ -92,17 +101,46 @@ parse_linux_cooked_capture(iterator data, iterator end) {
   uint16_t const payload_type =
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       ntohs(*reinterpret_cast<uint16_t const *>(&(*data)));
-  std::string const info =
-      "Linux cooked capture: src: " + binary_to_mac(ether_shost);
-  return std::make_unique<Link_layer>(Link_layer::lcc_header_size, ether_shost,
-                                      payload_type, info);
+  return Link_layer{Link_layer::Type::linux_cooked_capture,
+                    Link_layer::lcc_header_size, ether_shost, payload_type};
 }
 
 template <typename iterator>
-[[nodiscard]] std::unique_ptr<Link_layer> parse_ethernet(iterator data,
-                                                         iterator end) {
-  size_t const header_size = 14;
-  check_type_and_range(data, end, header_size);
+[[nodiscard]] std::optional<Link_layer>
+parse_linux_cooked_capture_v2(iterator data, iterator end) {
+  // see https://www.tcpdump.org/linktypes/LINKTYPE_LINUX_SLL2.html
+  check_type_and_range(data, end, Link_layer::lcc2_header_size);
+  uint16_t const payload_type =
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      ntohs(*reinterpret_cast<uint16_t const *>(&(*data)));
+  // skip reserved bytes and interface index
+  // NOLINTNEXTLINE
+  std::advance(data, 8);
+  uint16_t const device_type =
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      ntohs(*reinterpret_cast<uint16_t const *>(&(*data)));
+  if (device_type != ARPHRD_ETHER && device_type != ARPHRD_LOOPBACK) {
+    throw std::runtime_error(
+        "Linux_cooked_capture only supports ethernet or loopback, got: " +
+        to_string(device_type) + " (look in net/if_arp.h for value)");
+  }
+  // skip packet type
+  std::advance(data, 3);
+  if (*data != ETHER_ADDR_LEN) {
+    throw std::length_error("invalid link address size");
+  }
+  std::advance(data, 1);
+  ether_addr ether_shost{};
+  std::copy(data, data + ETHER_ADDR_LEN,
+            std::begin(ether_shost.ether_addr_octet));
+  return Link_layer{Link_layer::Type::linux_cooked_capture,
+                    Link_layer::lcc2_header_size, ether_shost, payload_type};
+}
+
+template <typename iterator>
+[[nodiscard]] std::optional<Link_layer> parse_ethernet(iterator data,
+                                                       iterator end) {
+  check_type_and_range(data, end, Link_layer::ethernet_header_size);
   ether_addr ether_dhost{};
   std::copy(data, data + ETHER_ADDR_LEN,
             std::begin(ether_dhost.ether_addr_octet));
@@ -114,37 +152,42 @@ template <typename iterator>
   uint16_t const ether_type =
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       ntohs(*reinterpret_cast<uint16_t const *>(&(*data)));
-  std::string const info = "Ethernet: dst = " + binary_to_mac(ether_dhost) +
-                           ", src = " + binary_to_mac(ether_shost);
-  return std::make_unique<Link_layer>(header_size, ether_shost, ether_type,
-                                      info);
+  return Link_layer{Link_layer::Type::ethernet,
+                    Link_layer::ethernet_header_size, ether_shost, ether_type,
+                    ether_dhost};
 }
 
 template <typename iterator>
-[[nodiscard]] std::unique_ptr<Link_layer> parse_VLAN_Header(iterator data,
-                                                            iterator end) {
-  size_t const header_size = 4;
-  check_type_and_range(data, end, header_size);
+[[nodiscard]] std::optional<Link_layer> parse_VLAN_Header(iterator data,
+                                                          iterator end) {
+  check_type_and_range(data, end, Link_layer::vlan_header_size);
   std::advance(data, 2);
   uint16_t const payload_type =
       // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
       ntohs(*reinterpret_cast<uint16_t const *>(&(*data)));
   ether_addr const ether_shost{{0}};
-  return std::make_unique<Link_layer>(header_size, ether_shost, payload_type,
-                                      "VLAN Header");
+  return Link_layer{Link_layer::Type::vlan, Link_layer::vlan_header_size,
+                    ether_shost, payload_type};
 }
 
 template <typename iterator>
-[[nodiscard]] std::unique_ptr<Link_layer>
+[[nodiscard]] std::optional<Link_layer>
 parse_link_layer(const int type, iterator data, iterator end) {
   switch (type) {
   case DLT_LINUX_SLL:
     return parse_linux_cooked_capture(data, end);
+  case DLT_LINUX_SLL2:
+    return parse_linux_cooked_capture_v2(data, end);
   case DLT_EN10MB:
     return parse_ethernet(data, end);
   case ETHERTYPE_VLAN:
     return parse_VLAN_Header(data, end);
   default:
-    return nullptr;
+    return std::nullopt;
   }
 }
+
+[[nodiscard]] inline std::optional<Link_layer>
+parse_link_layer(const int type, Packet_view const packet) {
+  return parse_link_layer(type, std::begin(packet), std::end(packet));
+}
@@ -0,0 +1,139 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include "ip_address.h"
+#include "poller.h"
+#include "socket.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/** identifies an echo request and its reply */
+struct Echo_id {
+  uint16_t id;
+  uint16_t sequence;
+
+  [[nodiscard]] bool operator==(Echo_id const &rhs) const = default;
+};
+
+/** ICMP or ICMPv6 echo request. the kernel computes the ICMPv6 checksum */
+[[nodiscard]] std::vector<uint8_t> create_echo_request(int family,
+                                                       Echo_id const &echo);
+
+/**
+ * the id of an echo reply received on a raw socket of family. IPv4 sockets
+ * receive the IP header as well, IPv6 sockets only the ICMPv6 message
+ */
+[[nodiscard]] std::optional<Echo_id>
+parse_echo_reply(int family, std::span<uint8_t const> data);
+
+/** non blocking raw ICMP or ICMPv6 socket */
+struct Icmp_socket : public Socket {
+  int const family;
+
+  explicit Icmp_socket(int familyy);
+
+  using Socket::fd;
+
+  /** link local addresses are reached via the interface with index scope */
+  void send_echo_request(IP_address const &ip, uint32_t scope,
+                         Echo_id const &echo);
+
+  /**
+   * reads a single packet. returns the echo reply and its source, nullopt if
+   * nothing was queued or the packet was no echo reply
+   */
+  [[nodiscard]] std::optional<std::pair<Echo_id, IP_address>>
+  receive_echo_reply();
+};
+
+/**
+ * Pings many addresses at once using one raw socket per IP version instead of
+ * a ping process per address. Replies are matched with their requests by the
+ * sequence number. A single thread waits for the replies and the timeouts of
+ * all requests.
+ */
+struct Icmp_prober {
+  /** how long ping -c 1 waits for a reply */
+  constexpr static auto default_timeout = std::chrono::milliseconds{10000};
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Request {
+    IP_address destination;
+    Clock::time_point deadline;
+    std::promise<bool> alive;
+  };
+
+  using Deadline = std::pair<Clock::time_point, uint16_t>;
+
+  uint16_t const id;
+  Icmp_socket icmp;
+  Icmp_socket icmp6;
+  Poller poller;
+  std::mutex mutex;
+  uint16_t next_sequence;
+  /** sequence number -> request waiting for its reply */
+  std::unordered_map<uint16_t, Request> pending;
+  /** earliest deadline first, answered requests are skipped */
+  std::priority_queue<Deadline, std::vector<Deadline>, std::greater<>>
+      deadlines;
+  std::atomic<bool> running;
+  std::thread thread;
+
+  void receive(Icmp_socket &sock);
+
+  /**
+   * answers all requests past their deadline with false. returns the ms until
+   * the next deadline, -1 if there is none
+   */
+  int expire();
+
+  void thread_main();
+
+public:
+  Icmp_prober();
+
+  Icmp_prober(Icmp_prober const &) = delete;
+  Icmp_prober(Icmp_prober &&) = delete;
+
+  ~Icmp_prober();
+
+  Icmp_prober &operator=(Icmp_prober const &) = delete;
+  Icmp_prober &operator=(Icmp_prober &&) = delete;
+
+  /**
+   * sends an echo request to ip. link local addresses are reached via iface.
+   * the future becomes true when the reply arrives and false after timeout
+   */
+  [[nodiscard]] std::future<bool>
+  probe(std::string const &iface, IP_address const &ip,
+        std::chrono::milliseconds timeout = default_timeout);
+};
@@ -22,9 +22,9 @@
 #include <arpa/inet.h>
 #include <cstdint>
 #include <iterator>
-#include <memory>
 #include <net/ethernet.h>
 #include <netinet/in.h>
+#include <optional>
 
 struct ip {
   constexpr static auto ipv4_header_size = uint8_t{20};
@@ -80,7 +80,7 @@ ethernet_payload_and_ip_version_dont_match(uint16_t const type, iterator data)
 [[nodiscard]] IP_address get_ipv6_address(const in6_addr &addr);
 
 template <typename iterator>
-[[nodiscard]] std::unique_ptr<ip> parse_ipv4(iterator data, iterator end) {
+[[nodiscard]] std::optional<ip> parse_ipv4(iterator data, iterator end) {
   check_type_and_range(data, end, ip::ipv4_header_size);
   uint8_t const ip_vhl = *data;
   size_t const header_length = static_cast<uint8_t>((ip_vhl & 0x0f) * 4);
@@ -98,15 +98,15 @@ template <typename iterator>
             // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
             reinterpret_cast<uint8_t *>(&ip_dst));
   static auto const no_subnet = uint8_t{32};
-  return std::make_unique<ip>(
+  return ip{
       ip::ipv4, header_length,
       IP_address{.family = AF_INET, .address = {ip_src}, .subnet = no_subnet},
       IP_address{.family = AF_INET, .address = {ip_dst}, .subnet = no_subnet},
-      ip_p);
+      ip_p};
 }
 
 template <typename iterator>
-[[nodiscard]] std::unique_ptr<ip> parse_ipv6(iterator data, iterator end) {
+[[nodiscard]] std::optional<ip> parse_ipv6(iterator data, iterator end) {
   check_type_and_range(data, end, ip::ipv6_header_size);
   // NOLINTNEXTLINE
   std::advance(data, 6);
@@ -119,17 +119,16 @@ template <typename iterator>
   in6_addr dest_address{};
   // NOLINTNEXTLINE
   std::copy(data, data + ip::ipv6_address_size_byte, dest_address.s6_addr);
-  return std::make_unique<ip>(ip::ipv6, ip::ipv6_header_size,
-                              get_ipv6_address(source_address),
-                              get_ipv6_address(dest_address), next_header);
+  return ip{ip::ipv6, ip::ipv6_header_size, get_ipv6_address(source_address),
+            get_ipv6_address(dest_address), next_header};
 }
 
 template <typename iterator>
-[[nodiscard]] std::unique_ptr<ip> parse_ip(uint16_t const type, iterator data,
-                                           iterator end) {
+[[nodiscard]] std::optional<ip> parse_ip(uint16_t const type, iterator data,
+                                         iterator end) {
   // check wether type and the version the ip headers matches
   if (ethernet_payload_and_ip_version_dont_match(type, data)) {
-    return nullptr;
+    return std::nullopt;
   }
   // construct the IPv4/IPv6 header
   switch (type) {
@@ -139,6 +138,11 @@ template <typename iterator>
     return parse_ipv6(data, end);
   // do not know the IP version which is given
   default:
-    return nullptr;
+    return std::nullopt;
   }
 }
+
+[[nodiscard]] inline std::optional<ip> parse_ip(uint16_t const type,
+                                                Packet_view const packet) {
+  return parse_ip(type, std::begin(packet), std::end(packet));
+}
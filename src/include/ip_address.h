@@ -17,8 +17,11 @@
 #pragma once
 
 #include <arpa/inet.h>
+#include <compare>
 #include <cstdint>
+#include <functional>
 #include <ostream>
+#include <span>
 #include <string>
 
 struct IP_address {
@@ -33,7 +36,24 @@ struct IP_address {
 
   [[nodiscard]] std::string with_subnet() const;
 
+  /** the address in network byte order, 4 bytes for IPv4 and 16 for IPv6 */
+  [[nodiscard]] std::span<uint8_t const> bytes() const;
+
+  /**
+   * the same address with a subnet containing only itself, like the
+   * addresses of parsed packets
+   */
+  [[nodiscard]] IP_address host() const;
+
+  /** compares the binary addresses, nothing is formatted */
   [[nodiscard]] bool operator==(const IP_address &rhs) const;
+
+  /** orders by family, address and subnet */
+  [[nodiscard]] std::strong_ordering operator<=>(const IP_address &rhs) const;
+};
+
+template <> struct std::hash<IP_address> {
+  [[nodiscard]] size_t operator()(const IP_address &ipa) const noexcept;
 };
 
 [[nodiscard]] IP_address parse_ip(const std::string &ip);
@@ -18,6 +18,7 @@
 
 #include "args.h"
 #include "ip_address.h"
+#include "pcap_wrapper.h"
 #include <cstdint>
 #include <string>
 
@@ -34,9 +35,34 @@ void reset_signaled();
 rule_to_listen_on_ips_and_ports(const std::vector<IP_address> &ips,
                                 const std::vector<uint16_t> &ports);
 
+/**
+ * pcap filter matching ARP packets and Neighbor Advertisements, which another
+ * node sends to claim one of ips
+ */
+[[nodiscard]] std::string
+rule_to_listen_on_address_claims(const std::vector<IP_address> &ips);
+
+struct Icmp_prober;
+
+/** pings of all hosts of this process share this prober */
+[[nodiscard]] Icmp_prober &get_icmp_prober();
+
+/** pings ip up to tries times until it replies */
 [[nodiscard]] bool ping_and_wait(const std::string &iface, const IP_address &ip,
                                  unsigned int tries);
 
+/** pcap filter matching every frame sent by mac */
+[[nodiscard]] std::string get_host_up_filter(const ether_addr &mac);
+
+/**
+ * waits until frames captures a frame, e.g. one matching get_host_up_filter()
+ * for a host just woken up, or ip answers one of tries pings. returns false
+ * if neither happened
+ */
+[[nodiscard]] bool wait_until_up(Pcap_wrapper &frames,
+                                 const std::string &iface,
+                                 const IP_address &ip, unsigned int tries);
+
 enum class Emulate_host_status : std::uint8_t {
   success,
   wake_failure,
@@ -45,4 +71,16 @@ enum class Emulate_host_status : std::uint8_t {
   undefined_error
 };
 
+struct Host_capture;
+
+/**
+ * Sets up firewall and IPs of the sleeping host, waits for an incoming SYN
+ * packet using an own pcap handle and wakes the host via WOL
+ */
 Emulate_host_status emulate_host(const Host_args &args);
+
+/**
+ * Same as emulate_host(args), but receives the SYN and magic packets from a
+ * Capture_engine shared with other hosts
+ */
+Emulate_host_status emulate_host(const Host_args &args, Host_capture &capture);
@@ -0,0 +1,62 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include "container_utils.h"
+#include <cstddef>
+#include <cstdint>
+#include <netinet/ether.h>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+/** instruction sets find_sync_stream() can use */
+enum class Simd_level : std::uint8_t { scalar, sse2, avx2 };
+
+/** the best instruction set supported by this CPU */
+[[nodiscard]] Simd_level best_simd_level();
+
+/**
+ * position of the first six 0xff bytes in data at or after from, which are
+ * followed by enough bytes to hold the 16 mac repetitions of a magic packet.
+ * returns data.size() if there is none
+ */
+[[nodiscard]] size_t find_sync_stream(Packet_view data, size_t from,
+                                      Simd_level level);
+
+[[nodiscard]] size_t find_sync_stream(Packet_view data, size_t from);
+
+/**
+ * Finds magic packets for any of a set of macs in a single pass over a packet
+ */
+struct Magic_packet_scanner {
+private:
+  /** mac packed into the lower 48 bits -> index of the host */
+  std::unordered_map<uint64_t, size_t> hosts;
+  Simd_level level;
+
+public:
+  explicit Magic_packet_scanner(std::vector<ether_addr> const &macs,
+                                Simd_level levell = best_simd_level());
+
+  /** index of the mac in macs data contains a magic packet for */
+  [[nodiscard]] std::optional<size_t> operator()(Packet_view data) const;
+};
+
+/** the mac a magic packet starting at position sync in data is meant for */
+[[nodiscard]] std::optional<ether_addr> magic_packet_mac(Packet_view data,
+                                                         size_t sync);
@@ -0,0 +1,85 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#pragma once
+
+#include "dad_prober.h"
+#include "ip_address.h"
+#include "netlink.h"
+#include "poller.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <netinet/ether.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Tells as soon as the kernel learns about a neighbor using one of the
+ * watched addresses with a mac other than the one of the interface. A single
+ * thread waits for the RTM_NEWNEIGH notifications of all watches.
+ */
+struct Neighbor_watcher {
+  /** called from the thread of the watcher, must not block */
+  using Claimed = std::function<void(Neighbor const &)>;
+
+private:
+  struct Watch {
+    int index;
+    IP_address ip;
+    /** neighbors with this mac are our own */
+    ether_addr own_mac;
+    Claimed claimed;
+  };
+
+  Netlink_socket netlink;
+  Poller poller;
+  std::mutex mutex;
+  uint64_t next_id;
+  std::unordered_map<uint64_t, Watch> watches;
+  std::atomic<bool> running;
+  std::thread thread;
+
+  /** calls the watches of the addresses of neighbors */
+  void notify(std::vector<Neighbor_info> const &neighbors);
+
+  void thread_main();
+
+public:
+  Neighbor_watcher();
+
+  Neighbor_watcher(Neighbor_watcher const &) = delete;
+  Neighbor_watcher(Neighbor_watcher &&) = delete;
+
+  ~Neighbor_watcher();
+
+  Neighbor_watcher &operator=(Neighbor_watcher const &) = delete;
+  Neighbor_watcher &operator=(Neighbor_watcher &&) = delete;
+
+  /**
+   * calls claimed whenever a neighbor on iface uses ip. returns the id to
+   * stop watching with
+   */
+  [[nodiscard]] uint64_t watch(std::string const &iface, IP_address const &ip,
+                               Claimed claimed);
+
+  /** claimed of the watch is not called anymore once this returns */
+  void unwatch(uint64_t id);
+};
@@ -0,0 +1,97 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include "ip_address.h"
+#include "scope_guard.h"
+#include "socket.h"
+#include <cstdint>
+#include <netinet/ether.h>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+/** what RTM_GETLINK tells about an interface */
+struct Link_info {
+  int index;
+  /** IFF_* flags */
+  unsigned int flags;
+  ether_addr address;
+};
+
+/** what RTM_NEWNEIGH tells about a neighbor */
+struct Neighbor_info {
+  /** index of the interface the neighbor has been seen on */
+  int index;
+  IP_address ip;
+  ether_addr address;
+};
+
+/**
+ * the neighbor of a RTM_NEWNEIGH message without its netlink header. nullopt
+ * if the kernel does not know its link-layer address
+ */
+[[nodiscard]] std::optional<Neighbor_info>
+parse_new_neighbor(std::span<uint8_t const> payload);
+
+/**
+ * rtnetlink socket to change and query the network configuration without
+ * running ip(8)
+ */
+struct Netlink_socket : public Socket {
+private:
+  /** the kernels answer to a single request */
+  struct Answer {
+    /** 0 or a negative errno */
+    int error;
+    uint16_t type;
+    /** the message without the netlink header */
+    std::vector<uint8_t> payload;
+  };
+
+  uint32_t sequence;
+
+  /**
+   * sends count requests in messages with the sequence numbers
+   * first_sequence onwards at once and waits for all of their answers
+   */
+  [[nodiscard]] std::vector<Answer>
+  transact(std::vector<uint8_t> const &messages, uint32_t first_sequence,
+           size_t count);
+
+public:
+  /** joins the multicast groups RTMGRP_* to receive their notifications */
+  explicit Netlink_socket(uint32_t groups = 0);
+
+  using Socket::fd;
+
+  /**
+   * adds ips to or removes them from the interface with index ifindex. all
+   * of them are sent in a single message batch
+   */
+  void change_addresses(Action action, int ifindex,
+                        std::vector<IP_address> const &ips);
+
+  [[nodiscard]] Link_info get_link(std::string const &iface);
+
+  /**
+   * reads the notifications queued on a socket which joined RTMGRP_NEIGH
+   * without blocking and returns the neighbors added or changed by them
+   */
+  [[nodiscard]] std::vector<Neighbor_info> receive_neighbors();
+};
@@ -18,16 +18,16 @@
 
 #include "ethernet.h"
 #include "ip.h"
-#include <memory>
+#include <optional>
 #include <pcap/pcap.h>
 #include <tuple>
 #include <vector>
 
 /**
- * Ethernet, IP and TCP/UDP header in one tuple
+ * Link layer and IP header in one tuple. Both are plain values, parsing them
+ * does not allocate
  * */
-using basic_headers =
-    std::tuple<std::unique_ptr<Link_layer>, std::unique_ptr<ip>>;
+using basic_headers = std::tuple<std::optional<Link_layer>, std::optional<ip>>;
 
 /**
  * Prints the headers to stdout
@@ -37,12 +37,84 @@ std::ostream &operator<<(std::ostream &out, const basic_headers &headers);
 /**
  * Extracts the Ethernet, IP and TCP/UDP headers from packet
  * */
-[[nodiscard]] basic_headers get_headers(int type,
-                                        const std::vector<u_char> &packet);
+[[nodiscard]] basic_headers get_headers(int type, Packet_view packet);
+
+/**
+ * Parses the VLAN and IP headers following the link layer header ll at the
+ * start of packet
+ * */
+[[nodiscard]] basic_headers get_headers(Link_layer const &ll,
+                                        Packet_view packet);
+
+/**
+ * get_headers() for packets of a single datalink DLT, which is known at
+ * compile time. Only DLT_EN10MB, DLT_LINUX_SLL and DLT_LINUX_SLL2 are
+ * supported
+ * */
+template <int DLT> struct Header_parser {
+  static_assert(DLT == DLT_EN10MB || DLT == DLT_LINUX_SLL ||
+                    DLT == DLT_LINUX_SLL2,
+                "unsupported datalink");
+
+  static int const datalink = DLT;
+
+  [[nodiscard]] basic_headers operator()(Packet_view const packet) const {
+    auto const begin = std::begin(packet);
+    auto const end = std::end(packet);
+    std::optional<Link_layer> ll;
+    if constexpr (DLT == DLT_EN10MB) {
+      ll = parse_ethernet(begin, end);
+    } else if constexpr (DLT == DLT_LINUX_SLL) {
+      ll = parse_linux_cooked_capture(begin, end);
+    } else {
+      ll = parse_linux_cooked_capture_v2(begin, end);
+    }
+    return get_headers(*ll, packet);
+  }
+};
+
+/** get_headers() for datalinks without a Header_parser */
+struct Any_header_parser {
+  int const datalink;
+
+  [[nodiscard]] basic_headers operator()(Packet_view const packet) const {
+    return get_headers(datalink, packet);
+  }
+};
+
+/**
+ * calls func with the Header_parser for datalink. meant to be called once
+ * for a capture, e.g. with Pcap_wrapper::get_datalink(), so that the code
+ * handling each packet does not need to look at the datalink
+ * */
+template <typename Func>
+decltype(auto) with_header_parser(int const datalink, Func &&func) {
+  switch (datalink) {
+  case DLT_EN10MB:
+    return func(Header_parser<DLT_EN10MB>{});
+  case DLT_LINUX_SLL:
+    return func(Header_parser<DLT_LINUX_SLL>{});
+  case DLT_LINUX_SLL2:
+    return func(Header_parser<DLT_LINUX_SLL2>{});
+  default:
+    return func(Any_header_parser{datalink});
+  }
+}
+
+/**
+ * Returns the TCP or UDP destination port of packet, if headers describe a
+ * TCP or UDP packet
+ * */
+[[nodiscard]] std::optional<uint16_t>
+get_destination_port(const basic_headers &headers, Packet_view packet);
+
+/** the data captured by pcap, without copying it */
+[[nodiscard]] Packet_view to_packet_view(const pcap_pkthdr &header,
+                                         const u_char *packet);
 
 /**
  * Saves the lower 3 layers and all the data which has been intercepted
- * using pcap.
+ * using pcap. The data is only copied if an IP header has been found.
  */
 struct Catch_incoming_connection {
   const int link_layer_type;
@@ -0,0 +1,103 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include "file_descriptor.h"
+#include "socket.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <pcap/pcap.h>
+#include <string>
+#include <vector>
+
+/** size and latency of the memory mapped ring of a Packet_ring */
+struct Ring_config {
+  /** size of each block, a multiple of the page size */
+  uint32_t block_size = 1U << 20U;
+  /** number of blocks in the ring */
+  uint32_t block_count = 8;
+  /** ms after which the kernel hands over a block, which is not full yet */
+  uint32_t block_timeout = 10;
+};
+
+/**
+ * Captures packets with an AF_PACKET socket and a TPACKET_V3 ring shared with
+ * the kernel. Callbacks get a pointer into the ring, packets are not copied.
+ * Sockets bound to "any" or to interfaces without an ethernet header deliver
+ * linux cooked captures, like libpcap does.
+ */
+struct Packet_ring : public Socket {
+private:
+  int const datalink;
+  uint32_t const snaplen;
+  Ring_config const config;
+  /** the ring shared with the kernel */
+  uint8_t *ring;
+  size_t ring_size;
+  /** index of the next block to read */
+  uint32_t current_block;
+  /** packets of current_block already handed to a callback */
+  uint32_t block_packets_read;
+  /** wakes up loop() when break_loop() is called */
+  File_descriptor const wakeup;
+  std::atomic<bool> break_requested;
+  /** the filter dropping everything until set_filter() has to be removed */
+  bool accept_all_pending;
+  /** filter, which could not be run by the kernel */
+  std::optional<bpf_program> userspace_filter;
+
+  void free_userspace_filter();
+
+  /** calls callback for each packet in block. returns true to stop the loop */
+  bool read_block(uint8_t *block, int &count, pcap_handler callback,
+                  u_char *user);
+
+public:
+  Packet_ring(std::string const &iface, uint32_t snaplenn,
+              Ring_config const &configg);
+
+  Packet_ring(Packet_ring const &) = delete;
+  Packet_ring(Packet_ring &&) = delete;
+
+  ~Packet_ring();
+
+  Packet_ring &operator=(Packet_ring const &) = delete;
+  Packet_ring &operator=(Packet_ring &&) = delete;
+
+  [[nodiscard]] int get_datalink() const;
+
+  /**
+   * compiles filter and attaches it to the socket. filters the kernel cannot
+   * run on the socket are applied to each packet in userspace instead
+   */
+  void set_filter(std::string const &filter);
+
+  /**
+   * calls callback with user for count packets or until break_loop(), like
+   * pcap_loop(). a count of zero or less captures until break_loop(). returns
+   * true if count packets have been captured
+   */
+  bool loop(int count, pcap_handler callback, u_char *user);
+
+  /** ends the current or next loop(), can be called from any thread */
+  void break_loop();
+
+  /** sends data. only possible on sockets bound to an ethernet interface */
+  int inject(std::vector<uint8_t> const &data);
+};
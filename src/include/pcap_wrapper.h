@@ -16,14 +16,17 @@
 
 #pragma once
 
+#include "packet_ring.h"
+#include "poller.h"
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <pcap/pcap.h>
 #include <string>
-#include <thread>
+#include <type_traits>
 #include <vector>
 
 /** Provide a nice interface to pcap and close the handle upon an exception */
@@ -41,16 +44,37 @@ private:
   std::array<char, PCAP_ERRBUF_SIZE> errbuf{{0}};
   /** pointer to the opened pcap_t struct with its close function */
   std::unique_ptr<pcap_t, void (*)(pcap_t *)> pc;
-  std::thread loop_thread;
-  std::unique_ptr<std::mutex> loop_end_reson_mutex;
-  Loop_end_reason loop_end_reason = Loop_end_reason::unset;
+  /** used instead of pc, if the TPACKET_V3 backend has been selected */
+  std::unique_ptr<Packet_ring> ring;
+  /** waits for packets on the selectable fd of pc */
+  std::unique_ptr<Poller> poller;
+  int selectable_fd;
+  std::unique_ptr<std::atomic<Loop_end_reason>> loop_end_reason;
+
+  void open(std::string const &iface, int snaplen, bool promisc, int timeout);
+
+  /** the C callback for a handler of type Handler passed as user */
+  template <typename Handler>
+  static void call_handler(u_char *const user, const pcap_pkthdr *header,
+                           const u_char *packet) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    (*reinterpret_cast<Handler *>(user))(header, packet);
+  }
 
 protected:
-  /** this is only present to run tests as non-root, do not use */
+  /**
+   * creates an instance without a pcap handle. used by captures which get
+   * their packets from somewhere else, e.g. Host_capture, and to run tests as
+   * non-root
+   */
   Pcap_wrapper();
 
   [[nodiscard]] Loop_end_reason get_end_reason() const;
 
+  /** calls callback with user for count packets, like pcap_loop() */
+  virtual Loop_end_reason run_loop(int count, pcap_handler callback,
+                                   u_char *user);
+
 public:
   static int const default_snaplen = 65000;
   static int const default_timeout = 1000;
@@ -59,6 +83,13 @@ public:
   explicit Pcap_wrapper(std::string const &iface, int snaplen = default_snaplen,
                         bool promisc = false, int timeout = default_timeout);
 
+  /**
+   * open a TPACKET_V3 ring on iface. falls back to libpcap if the ring cannot
+   * be set up
+   */
+  Pcap_wrapper(std::string const &iface, Ring_config const &ring_config,
+               int snaplen = default_snaplen);
+
   Pcap_wrapper(Pcap_wrapper const &) = delete;
   Pcap_wrapper(Pcap_wrapper &&) = default;
 
@@ -68,19 +99,43 @@ public:
   Pcap_wrapper &operator=(Pcap_wrapper &&) = default;
 
   /** tell if the first header is ethernet, unix socket, ... */
-  [[nodiscard]] int get_datalink() const;
+  [[nodiscard]] virtual int get_datalink() const;
 
   [[nodiscard]] std::string get_verbose_datalink() const;
 
   /** sets a BPF (berkeley packet filter) filter the pcap instance */
   void set_filter(const std::string &filter);
 
+  /**
+   * sniff count packets calling handler each time. the type of handler is
+   * known to the callback given to libpcap, so the compiler can inline it
+   */
+  template <typename Handler>
+  Pcap_wrapper::Loop_end_reason loop(int const count, Handler &&handler) {
+    using Handler_t = std::remove_reference_t<Handler>;
+    auto *const user = const_cast<std::remove_const_t<Handler_t> *>(
+        std::addressof(handler));
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    return run_loop(count, call_handler<Handler_t>,
+                    reinterpret_cast<u_char *>(user));
+  }
+
   /** sniff count packets calling cb each time */
   using Callback_t =
       std::function<void(const struct pcap_pkthdr *, const u_char *)>;
-  virtual Pcap_wrapper::Loop_end_reason loop(int count, Callback_t cb);
+  Pcap_wrapper::Loop_end_reason loop(int count, Callback_t cb);
 
-  void break_loop(const Loop_end_reason &ler);
+  /**
+   * ends the current or next loop(). it only stores ler and writes to an
+   * eventfd, so it is safe to call it from signal handlers
+   */
+  virtual void break_loop(const Loop_end_reason &ler);
 
   int inject(const std::vector<uint8_t> &data);
 };
+
+/**
+ * pcap_compile() is not thread safe
+ * see http://seclists.org/tcpdump/2012/q2/22
+ */
+[[nodiscard]] std::mutex &get_pcap_compile_mutex();
@@ -0,0 +1,66 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#pragma once
+
+#include "file_descriptor.h"
+#include <atomic>
+#include <functional>
+#include <unordered_map>
+
+/**
+ * Waits with epoll until one of several file descriptors is readable and
+ * calls their handlers. The captures of several Pcap_wrappers can be served
+ * by a single thread this way.
+ */
+struct Poller {
+  using Handler = std::function<void()>;
+
+private:
+  File_descriptor const epoll;
+  /** makes epoll_wait() return when wake() is called */
+  File_descriptor const wakeup;
+  std::atomic<bool> woken;
+  std::unordered_map<int, Handler> handlers;
+
+public:
+  Poller();
+
+  Poller(Poller const &) = delete;
+  Poller(Poller &&) = delete;
+
+  ~Poller();
+
+  Poller &operator=(Poller const &) = delete;
+  Poller &operator=(Poller &&) = delete;
+
+  /** calls handler from poll() whenever fd is readable */
+  void add(int fd, Handler handler);
+
+  void remove(int fd);
+
+  /**
+   * waits at most timeout ms, -1 waits forever, and calls the handlers of all
+   * readable file descriptors. returns false if wake() ended the wait
+   */
+  bool poll(int timeout = -1);
+
+  /**
+   * ends the current or next poll() without running any handler. can be
+   * called from any thread and from signal handlers
+   */
+  void wake();
+};
@@ -22,6 +22,10 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <ostream>
+#include <string>
+#include <variant>
+#include <vector>
 
 /** perform or reverse the modification */
 enum struct Action : std::uint8_t { add, del };
@@ -89,11 +93,25 @@ struct Temp_ip {
   std::string operator()(Action action) const;
 };
 
+/**
+ * Adds all ips to iface at once using rtnetlink, removes them afterwards.
+ * Does the work itself and returns no command
+ */
+struct Temp_ips {
+  const std::string iface;
+  const std::vector<IP_address> ips;
+
+  std::string operator()(Action action) const;
+};
+
 /** Adds a firewall rule to open port for ip */
 struct Drop_port {
   const IP_address ip;
   const uint16_t port;
 
+  /** the rule as iptables-restore reads it */
+  [[nodiscard]] std::string rule(Action action) const;
+
   std::string operator()(Action action) const;
 };
 
@@ -103,6 +121,9 @@ struct Reject_tp {
   const IP_address ip;
   const TP tcp_udp;
 
+  /** the rule as iptables-restore reads it */
+  [[nodiscard]] std::string rule(Action action) const;
+
   std::string operator()(Action action) const;
 };
 
@@ -110,15 +131,77 @@ struct Reject_tp {
 struct Block_icmp {
   const IP_address ip;
 
+  /** the rule as iptables-restore reads it */
+  [[nodiscard]] std::string rule(Action action) const;
+
   std::string operator()(Action action) const;
 };
 
 struct Block_ipv6_neighbor_solicitation {
   const IP_address ip;
 
+  /** the rule as iptables-restore reads it */
+  [[nodiscard]] std::string rule(Action action) const;
+
   std::string operator()(Action action) const;
 };
 
+using Firewall_rule = std::variant<Drop_port, Reject_tp, Block_icmp,
+                                   Block_ipv6_neighbor_solicitation>;
+
+/**
+ * Adds or removes all rules with a single call of iptables-restore per IP
+ * version, so that either all or none of them are changed. Does the work
+ * itself and returns no command
+ */
+struct Firewall_transaction {
+  std::vector<Firewall_rule> rules;
+
+  /** input of iptables-restore for the rules of IP version family */
+  [[nodiscard]] std::string ruleset(int family, Action action) const;
+
+  std::string operator()(Action action) const;
+};
+
+/** which tool puts the firewall rules in place */
+enum struct Firewall_backend : std::uint8_t { iptables, nftables };
+
+/**
+ * validates and converts human readable firewall backend into its respective
+ * enum
+ */
+[[nodiscard]] Firewall_backend
+parse_firewall_backend(const std::string &backend);
+
+std::ostream &operator<<(std::ostream &out, const Firewall_backend &backend);
+
+/**
+ * the nftables table shared by all hosts. It holds one rule per kind of
+ * Firewall_rule, which matches against a set of addresses. Replaces any
+ * table left from previous runs
+ */
+[[nodiscard]] std::string get_nft_table();
+
+/**
+ * Puts the addresses and ports of all rules into the sets of the table from
+ * get_nft_table() or removes them in a single nft call. The number of rules
+ * stays the same no matter how many hosts are handled. Does the work itself
+ * and returns no command
+ */
+struct Nft_transaction {
+  std::vector<Firewall_rule> rules;
+
+  /** input of nft changing the set elements of all rules */
+  [[nodiscard]] std::string ruleset(Action action) const;
+
+  std::string operator()(Action action) const;
+};
+
+/** transaction changing rules with backend */
+[[nodiscard]] Scope_guard::Aquire_release
+firewall_transaction(Firewall_backend backend,
+                     std::vector<Firewall_rule> rules);
+
 /** adds and removes an element of type T to container of type Cont */
 template <typename Cont, typename T> struct Ptr_guard {
   Cont &cont;
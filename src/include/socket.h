@@ -88,4 +88,7 @@ public:
   [[nodiscard]] int get_ifindex(const std::string &iface) const;
 
   [[nodiscard]] ether_addr get_hwaddr(const std::string &iface) const;
+
+  /** ARPHRD_* type of the hardware address of iface */
+  [[nodiscard]] uint16_t get_hwtype(const std::string &iface) const;
 };
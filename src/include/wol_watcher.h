@@ -14,15 +14,29 @@
 // with this program; if not, write to the Free Software Foundation, Inc.,
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
+#pragma once
+
+#include "container_utils.h"
 #include "pcap_wrapper.h"
 #include "scope_guard.h"
 #include <cstdint>
 #include <netinet/ether.h>
 #include <string>
 #include <thread>
+#include <vector>
+
+/** pcap filter matching all packets, which might carry a magic packet */
+[[nodiscard]] std::string get_wol_filter();
+
+/**
+ * pcap filter matching only magic packets for one of macs, which start right
+ * at the UDP or ethernet payload. Lets the kernel drop everything else
+ */
+[[nodiscard]] std::string get_wol_filter(std::vector<ether_addr> const &macs,
+                                         int datalink);
 
-[[nodiscard]] bool is_magic_packet(std::vector<uint8_t> const &data,
-                                   ether_addr const &mac);
+/** checks if data contains a magic packet for mac */
+[[nodiscard]] bool is_magic_packet(Packet_view data, ether_addr const &mac);
 
 void break_on_magic_packet(const struct pcap_pkthdr *header,
                            const u_char *packet, ether_addr const &mac,
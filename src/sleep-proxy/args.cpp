@@ -35,6 +35,7 @@ const std::string def_mac = "01:12:34:45:67:89";
 const std::string def_hostname;
 const std::string def_ping_tries = "5";
 const std::string def_wol_method = "ethernet";
+const std::string def_firewall = "iptables";
 
 Host_args read_args(std::ifstream &file) {
   std::string interface = def_iface;
@@ -44,6 +45,7 @@ Host_args read_args(std::ifstream &file) {
   std::string hostname = def_hostname;
   std::string ping_tries = def_ping_tries;
   std::string wol_method = def_wol_method;
+  std::string firewall = def_firewall;
   std::string line;
   while (std::getline(file, line) && line.substr(0, 4) != "host") {
     if (line.empty()) {
@@ -70,6 +72,8 @@ Host_args read_args(std::ifstream &file) {
       ping_tries = token.at(1);
     } else if (token.at(0) == "wol_method") {
       wol_method = token.at(1);
+    } else if (token.at(0) == "firewall") {
+      firewall = token.at(1);
     } else {
       log_string(LOG_INFO, "unknown name \"" + token.at(0) + "\": skipping");
     }
@@ -84,7 +88,7 @@ Host_args read_args(std::ifstream &file) {
   }
 
   return parse_host_args(interface, address, ports, mac, hostname, ping_tries,
-                         wol_method);
+                         wol_method, firewall);
 }
 
 std::vector<Host_args> read_file(const std::string &filename) {
@@ -120,7 +124,8 @@ Host_args parse_host_args(const std::string &interface_,
                           const std::vector<std::string> &ports_,
                           const std::string &mac_, const std::string &hostname_,
                           const std::string &ping_tries_,
-                          const std::string &wol_method_) {
+                          const std::string &wol_method_,
+                          const std::string &firewall_) {
 
   Host_args hargs(validate_iface(interface_), parse_items(addresss_, parse_ip),
                   parse_items(ports_, str_to_integral<uint16_t>),
@@ -128,7 +133,8 @@ Host_args parse_host_args(const std::string &interface_,
                   test_characters(hostname_, iface_chars + "-",
                                   "invalid token in hostname: " + hostname_),
                   str_to_integral<unsigned int>(ping_tries_),
-                  parse_wol_method(wol_method_));
+                  parse_wol_method(wol_method_),
+                  parse_firewall_backend(firewall_));
   if (hargs.address.empty()) {
     throw std::runtime_error("no ip address given");
   }
@@ -188,7 +194,8 @@ std::ostream &operator<<(std::ostream &out, const Host_args &args) {
       << ", mac = " << binary_to_mac(args.mac)
       << ", hostname = " << args.hostname
       << ", print_tries = " << args.ping_tries
-      << ", wol_method = " << args.wol_method << ")";
+      << ", wol_method = " << args.wol_method
+      << ", firewall = " << args.firewall << ")";
   return out;
 }
 
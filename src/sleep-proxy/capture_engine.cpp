@@ -0,0 +1,234 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "capture_engine.h"
+#include "dad_prober.h"
+#include "libsleep_proxy.h"
+#include "log.h"
+#include "packet_parser.h"
+#include "wol_watcher.h"
+#include <algorithm>
+#include <csignal>
+#include <iterator>
+
+Host_capture::Host_capture(int const datalinkk) : datalink{datalinkk} {}
+
+Host_capture::~Host_capture() = default;
+
+int Host_capture::get_datalink() const { return datalink; }
+
+Pcap_wrapper::Loop_end_reason
+Host_capture::run_loop(int const count, pcap_handler const callbackk,
+                       u_char *const userr) {
+  std::unique_lock<std::mutex> lock{mutex};
+  if (pending_break.has_value()) {
+    reason = *pending_break;
+    pending_break.reset();
+    return reason;
+  }
+  callback = callbackk;
+  user = userr;
+  remaining = count;
+  reason = Loop_end_reason::unset;
+  listening = true;
+  stopped.wait(lock, [&] { return !listening; });
+  callback = nullptr;
+  user = nullptr;
+  return reason;
+}
+
+void Host_capture::break_loop(const Loop_end_reason &ler) {
+  std::lock_guard<std::mutex> const lock{mutex};
+  if (!listening) {
+    pending_break = ler;
+    return;
+  }
+  reason = ler;
+  listening = false;
+  stopped.notify_all();
+}
+
+void Host_capture::reset() {
+  std::lock_guard<std::mutex> const lock{mutex};
+  pending_break.reset();
+}
+
+bool Host_capture::is_listening() {
+  std::lock_guard<std::mutex> const lock{mutex};
+  return listening;
+}
+
+bool Host_capture::deliver(const pcap_pkthdr *header, const u_char *packet) {
+  std::lock_guard<std::mutex> const lock{mutex};
+  if (!listening) {
+    return false;
+  }
+  callback(user, header, packet);
+  // like pcap_loop() a count of zero or less captures until break_loop()
+  if (remaining > 0 && --remaining == 0) {
+    reason = Loop_end_reason::packets_captured;
+    listening = false;
+    stopped.notify_all();
+  }
+  return true;
+}
+
+namespace {
+std::vector<ether_addr> get_macs(std::vector<Host_args> const &hosts) {
+  std::vector<ether_addr> macs;
+  std::ranges::transform(hosts, std::back_inserter(macs),
+                         [](Host_args const &host) { return host.mac; });
+  return macs;
+}
+} // namespace
+
+Host_lookup::Host_lookup(std::vector<Host_args> const &hosts)
+    : by_address{}, ports{}, magic_packets{get_macs(hosts)} {
+  for (size_t i = 0; i < hosts.size(); i++) {
+    for (auto const &ip : hosts.at(i).address) {
+      if (!by_address.emplace(ip.host(), i).second) {
+        log_string(LOG_ERR, "address " + ip.pure() +
+                                " is configured for more than one host");
+      }
+    }
+    ports.push_back(hosts.at(i).ports);
+  }
+}
+
+Demux_result Host_lookup::operator()(int const datalink,
+                                     Packet_view const packet) const {
+  return demux(get_headers(datalink, packet), packet);
+}
+
+Demux_result Host_lookup::demux(basic_headers const &headers,
+                                Packet_view const packet) const {
+  auto const claim = get_address_claim(headers, packet);
+  if (claim.has_value()) {
+    auto const host = by_address.find(claim->ip);
+    if (host != std::end(by_address)) {
+      return {.kind = Demux_result::Kind::address_claim, .host = host->second};
+    }
+    return {.kind = Demux_result::Kind::none, .host = 0};
+  }
+  auto const &ipp = std::get<1>(headers);
+  if (ipp.has_value() && ipp->payload_protocol() == ip::TCP) {
+    auto const host = by_address.find(ipp->destination());
+    auto const port = get_destination_port(headers, packet);
+    if (host != std::end(by_address) && port.has_value() &&
+        std::ranges::find(ports.at(host->second), *port) !=
+            std::end(ports.at(host->second))) {
+      return {.kind = Demux_result::Kind::syn, .host = host->second};
+    }
+    return {.kind = Demux_result::Kind::none, .host = 0};
+  }
+  auto const host = magic_packets(packet);
+  if (host.has_value()) {
+    return {.kind = Demux_result::Kind::magic_packet, .host = *host};
+  }
+  return {.kind = Demux_result::Kind::none, .host = 0};
+}
+
+std::string rule_to_listen_on_hosts(std::vector<Host_args> const &hosts,
+                                    int const datalink) {
+  std::vector<IP_address> ips;
+  std::vector<uint16_t> ports;
+  for (auto const &host : hosts) {
+    ips.insert(std::end(ips), std::begin(host.address), std::end(host.address));
+    ports.insert(std::end(ports), std::begin(host.ports), std::end(host.ports));
+  }
+  std::ranges::sort(ports);
+  auto const [first, last] = std::ranges::unique(ports);
+  ports.erase(first, last);
+  return "(" + rule_to_listen_on_ips_and_ports(ips, ports) + ") or (" +
+         get_wol_filter(get_macs(hosts), datalink) + ") or (" +
+         rule_to_listen_on_address_claims(ips) + ")";
+}
+
+Capture_engine::Capture_engine(std::string const &iface,
+                               std::vector<Host_args> const &hosts)
+    : pc{iface, Ring_config{}}, lookup{hosts}, captures{}, capture_thread{} {
+  auto const datalink = pc.get_datalink();
+  captures.reserve(hosts.size());
+  for (size_t i = 0; i < hosts.size(); i++) {
+    captures.emplace_back(std::make_unique<Host_capture>(datalink));
+  }
+  std::string const filter = rule_to_listen_on_hosts(hosts, datalink);
+  log_string(LOG_INFO, "Capturing for " + to_string(hosts.size()) +
+                           " hosts on " + iface + " with filter: " + filter);
+  pc.set_filter(filter);
+  capture_thread = std::thread(&Capture_engine::thread_main, this);
+}
+
+Capture_engine::~Capture_engine() { stop(); }
+
+Host_capture &Capture_engine::host_capture(size_t const index) {
+  return *captures.at(index);
+}
+
+template <typename Parser>
+void Capture_engine::dispatch(Parser const &parser, const pcap_pkthdr *header,
+                              const u_char *packet) {
+  if (header == nullptr || packet == nullptr) {
+    log_string(LOG_ERR, "header or packet are nullptr");
+    return;
+  }
+  try {
+    auto const result = lookup(parser, to_packet_view(*header, packet));
+    switch (result.kind) {
+    case Demux_result::Kind::syn:
+      captures.at(result.host)->deliver(header, packet);
+      break;
+    case Demux_result::Kind::magic_packet:
+      // someone else woke the host, same as Wol_watcher does
+    case Demux_result::Kind::address_claim:
+      // the host is back and announces its address
+      if (captures.at(result.host)->is_listening()) {
+        captures.at(result.host)
+            ->break_loop(Pcap_wrapper::Loop_end_reason::duplicate_address);
+      }
+      break;
+    case Demux_result::Kind::none:
+      break;
+    default:
+      break;
+    }
+  } catch (std::exception const &e) {
+    log_string(LOG_ERR,
+               std::string("Capture_engine caught an exception: ") + e.what());
+  }
+}
+
+void Capture_engine::thread_main() {
+  try {
+    // the datalink does not change, look at it only once
+    with_header_parser(pc.get_datalink(), [this](auto const parser) {
+      pc.loop(0, [this, parser](const pcap_pkthdr *header,
+                                const u_char *packet) {
+        dispatch(parser, header, packet);
+      });
+    });
+  } catch (std::exception const &e) {
+    log(LOG_ERR, "Capture_engine stopped capturing: %s", e.what());
+    raise(SIGTERM);
+  }
+}
+
+void Capture_engine::stop() {
+  pc.break_loop(Pcap_wrapper::Loop_end_reason::signal);
+  if (capture_thread.joinable()) {
+    capture_thread.join();
+  }
+}
@@ -0,0 +1,400 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "dad_prober.h"
+#include "ethernet.h"
+#include "log.h"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <linux/if_packet.h>
+#include <net/ethernet.h>
+#include <netinet/icmp6.h>
+#include <stdexcept>
+
+namespace {
+auto const arp_size = size_t{28};
+auto const arp_request = uint8_t{1};
+auto const arp_reply = uint8_t{2};
+auto const solicitation_size = size_t{32};
+auto const advertisement_header_size = size_t{24};
+auto const ipv4_size = size_t{4};
+auto const ipv6_size = size_t{16};
+
+IP_address to_ipv4(std::span<uint8_t const> const data) {
+  in_addr address{};
+  std::memcpy(&address, data.data(), ipv4_size);
+  static auto const no_subnet = uint8_t{32};
+  return IP_address{
+      .family = AF_INET, .address = {address}, .subnet = no_subnet};
+}
+
+IP_address to_ipv6(std::span<uint8_t const> const data) {
+  static auto const all_bits_specified = uint8_t{128};
+  IP_address ipa{};
+  ipa.family = AF_INET6;
+  // NOLINTNEXTLINE
+  std::memcpy(&ipa.address.ipv6, data.data(), ipv6_size);
+  ipa.subnet = all_bits_specified;
+  return ipa;
+}
+
+ether_addr to_mac(std::span<uint8_t const> const data) {
+  ether_addr mac{};
+  std::memcpy(&mac, data.data(), ETH_ALEN);
+  return mac;
+}
+
+std::span<uint8_t const> to_bytes(ether_addr const &mac) {
+  return std::span<uint8_t const>{mac.ether_addr_octet};
+}
+
+bool is_same_mac(ether_addr const &lhs, ether_addr const &rhs) {
+  return std::ranges::equal(lhs.ether_addr_octet, rhs.ether_addr_octet);
+}
+
+void check_family(IP_address const &ip, int const family) {
+  if (ip.family != family) {
+    throw std::invalid_argument("wrong ip version of " + ip.pure());
+  }
+}
+
+/** reads a single packet into buffer, returns how much was read */
+std::optional<size_t> receive(int const fd, std::span<uint8_t> const buffer,
+                              sockaddr *const source,
+                              socklen_t *const source_length) {
+  auto const received =
+      recvfrom(fd, buffer.data(), buffer.size(), 0, source, source_length);
+  if (received == -1) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      log_string(LOG_ERR,
+                 std::string("recvfrom() failed: ") + strerror(errno));
+    }
+    return std::nullopt;
+  }
+  return static_cast<size_t>(received);
+}
+} // namespace
+
+std::vector<uint8_t> create_arp_probe(ether_addr const &mac,
+                                      IP_address const &ip) {
+  check_family(ip, AF_INET);
+  // NOLINTBEGIN
+  std::vector<uint8_t> probe{// ethernet, IPv4, address lengths
+                             0, 1, 8, 0, ETH_ALEN, ipv4_size,
+                             // operation
+                             0, arp_request};
+  // NOLINTEND
+  auto const mac_bytes = to_bytes(mac);
+  probe.insert(std::end(probe), std::begin(mac_bytes), std::end(mac_bytes));
+  // unspecified sender address and unknown target mac
+  probe.resize(probe.size() + ipv4_size + ETH_ALEN);
+  auto const ip_bytes = ip.bytes();
+  probe.insert(std::end(probe), std::begin(ip_bytes), std::end(ip_bytes));
+  return probe;
+}
+
+std::optional<Neighbor> parse_arp_reply(std::span<uint8_t const> const data) {
+  auto const neighbor = parse_arp_sender(data);
+  // NOLINTNEXTLINE
+  if (!neighbor.has_value() || data[7] != arp_reply) {
+    return std::nullopt;
+  }
+  return neighbor;
+}
+
+std::optional<Neighbor> parse_arp_sender(std::span<uint8_t const> const data) {
+  // NOLINTBEGIN
+  if (data.size() < arp_size || data[0] != 0 || data[1] != 1 ||
+      data[2] != 8 || data[3] != 0 || data[4] != ETH_ALEN ||
+      data[5] != ipv4_size || data[6] != 0 ||
+      (data[7] != arp_request && data[7] != arp_reply)) {
+    return std::nullopt;
+  }
+  auto const sender = data.subspan(14, ipv4_size);
+  if (std::ranges::all_of(sender,
+                          [](uint8_t const byte) { return byte == 0; })) {
+    return std::nullopt;
+  }
+  return Neighbor{.ip = to_ipv4(sender),
+                  .mac = to_mac(data.subspan(8, ETH_ALEN))};
+  // NOLINTEND
+}
+
+std::vector<uint8_t> create_neighbor_solicitation(ether_addr const &mac,
+                                                  IP_address const &ip) {
+  check_family(ip, AF_INET6);
+  // type, code, checksum and reserved
+  std::vector<uint8_t> solicitation{ND_NEIGHBOR_SOLICIT, 0, 0, 0, 0, 0, 0, 0};
+  auto const ip_bytes = ip.bytes();
+  solicitation.insert(std::end(solicitation), std::begin(ip_bytes),
+                      std::end(ip_bytes));
+  // source link-layer address option, its length is counted in 8 bytes
+  solicitation.push_back(ND_OPT_SOURCE_LINKADDR);
+  solicitation.push_back(1);
+  auto const mac_bytes = to_bytes(mac);
+  solicitation.insert(std::end(solicitation), std::begin(mac_bytes),
+                      std::end(mac_bytes));
+  return solicitation;
+}
+
+std::optional<Neighbor>
+parse_neighbor_advertisement(std::span<uint8_t const> const data) {
+  if (data.size() < advertisement_header_size ||
+      data[0] != ND_NEIGHBOR_ADVERT || data[1] != 0) {
+    return std::nullopt;
+  }
+  static auto const target_offset = size_t{8};
+  Neighbor neighbor{.ip = to_ipv6(data.subspan(target_offset, ipv6_size)),
+                    .mac = {}};
+  static auto const option_unit = size_t{8};
+  auto options = data.subspan(advertisement_header_size);
+  while (options.size() >= option_unit && options[1] != 0) {
+    auto const length = options[1] * option_unit;
+    if (length > options.size()) {
+      break;
+    }
+    if (options[0] == ND_OPT_TARGET_LINKADDR && length >= 2 + ETH_ALEN) {
+      neighbor.mac = to_mac(options.subspan(2, ETH_ALEN));
+    }
+    options = options.subspan(length);
+  }
+  return neighbor;
+}
+
+std::optional<Neighbor> get_address_claim(basic_headers const &headers,
+                                          Packet_view const packet) {
+  auto const &ll = std::get<0>(headers);
+  if (!ll.has_value()) {
+    return std::nullopt;
+  }
+  auto offset = ll->header_length();
+  auto payload_type = ll->payload_protocol();
+  if (payload_type == ETHERTYPE_VLAN) {
+    // the type of the payload follows the tag control information
+    if (packet.size() < offset + Link_layer::vlan_header_size) {
+      return std::nullopt;
+    }
+    static auto const byte_size = uint8_t{8};
+    payload_type = static_cast<uint16_t>(packet[offset + 2] << byte_size |
+                                         packet[offset + 3]);
+    offset += Link_layer::vlan_header_size;
+  }
+  if (payload_type == ETHERTYPE_ARP) {
+    return offset < packet.size() ? parse_arp_sender(packet.subspan(offset))
+                                  : std::nullopt;
+  }
+  auto const &ipp = std::get<1>(headers);
+  if (!ipp.has_value() || ipp->version() != ip::ipv6 ||
+      ipp->payload_protocol() != IPPROTO_ICMPV6 ||
+      offset + ipp->header_length() >= packet.size()) {
+    return std::nullopt;
+  }
+  auto neighbor = parse_neighbor_advertisement(
+      packet.subspan(offset + ipp->header_length()));
+  // without the target link-layer address the sender claims the address
+  if (neighbor.has_value() && is_same_mac(neighbor->mac, ether_addr{})) {
+    neighbor->mac = ll->source();
+  }
+  return neighbor;
+}
+
+IP_address get_solicited_node_address(IP_address const &ip) {
+  check_family(ip, AF_INET6);
+  // ff02::1:ff00:0/104 followed by the last 24 bits of ip
+  // NOLINTNEXTLINE
+  std::array<uint8_t, ipv6_size> address{0xff, 2, 0, 0, 0, 0, 0, 0,
+                                         0,    0, 0, 1, 0xff};
+  static auto const copied_bytes = size_t{3};
+  std::ranges::copy(ip.bytes().last(copied_bytes),
+                    std::end(address) - copied_bytes);
+  return to_ipv6(address);
+}
+
+Arp_socket::Arp_socket()
+    : Socket{AF_PACKET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC,
+             htons(ETH_P_ARP)} {}
+
+void Arp_socket::send_probe(int const ifindex, ether_addr const &mac,
+                            IP_address const &ip) {
+  sockaddr_ll const broadcast{.sll_family = AF_PACKET,
+                              .sll_protocol = htons(ETH_P_ARP),
+                              .sll_ifindex = ifindex,
+                              .sll_hatype = 0,
+                              .sll_pkttype = 0,
+                              .sll_halen = ETH_ALEN,
+                              // NOLINTNEXTLINE
+                              .sll_addr = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff}};
+  send_to(create_arp_probe(mac, ip), 0, broadcast);
+}
+
+std::optional<Neighbor> Arp_socket::receive_reply() {
+  std::array<uint8_t, arp_size> buffer{};
+  sockaddr_ll source{};
+  socklen_t source_length = sizeof(source);
+  auto const received =
+      receive(fd(), buffer,
+              // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+              reinterpret_cast<sockaddr *>(&source), &source_length);
+  // the packet socket sees the probes we send as well
+  if (!received.has_value() || source.sll_pkttype == PACKET_OUTGOING) {
+    return std::nullopt;
+  }
+  return parse_arp_reply(std::span{buffer}.first(*received));
+}
+
+Ndp_socket::Ndp_socket()
+    : Socket{AF_INET6, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC,
+             IPPROTO_ICMPV6} {
+  icmp6_filter filter{};
+  ICMP6_FILTER_SETBLOCKALL(&filter);
+  ICMP6_FILTER_SETPASS(ND_NEIGHBOR_ADVERT, &filter);
+  set_sock_opt(IPPROTO_ICMPV6, ICMP6_FILTER, filter);
+  // neighbor discovery messages with another hop limit are dropped
+  static auto const hop_limit = int{255};
+  set_sock_opt(IPPROTO_IPV6, IPV6_MULTICAST_HOPS, hop_limit);
+  set_sock_opt(IPPROTO_IPV6, IPV6_UNICAST_HOPS, hop_limit);
+}
+
+void Ndp_socket::send_solicitation(int const ifindex, ether_addr const &mac,
+                                   IP_address const &ip) {
+  sockaddr_in6 const destination{
+      .sin6_family = AF_INET6,
+      .sin6_port = 0,
+      .sin6_flowinfo = 0,
+      .sin6_addr = get_solicited_node_address(ip).address.ipv6,
+      .sin6_scope_id = static_cast<uint32_t>(ifindex)};
+  send_to(create_neighbor_solicitation(mac, ip), 0, destination);
+}
+
+std::optional<Neighbor> Ndp_socket::receive_advertisement() {
+  static auto const max_packet_size = size_t{1500};
+  std::array<uint8_t, max_packet_size> buffer{};
+  sockaddr_in6 source{};
+  socklen_t source_length = sizeof(source);
+  auto const received =
+      receive(fd(), buffer,
+              // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+              reinterpret_cast<sockaddr *>(&source), &source_length);
+  if (!received.has_value()) {
+    return std::nullopt;
+  }
+  return parse_neighbor_advertisement(std::span{buffer}.first(*received));
+}
+
+Dad_prober::Dad_prober()
+    : arp{}, ndp{}, poller{}, mutex{}, next_id{0}, pending{}, deadlines{},
+      running{true}, thread{} {
+  poller.add(arp.fd(), [this] { answer(arp.receive_reply()); });
+  poller.add(ndp.fd(), [this] { answer(ndp.receive_advertisement()); });
+  thread = std::thread(&Dad_prober::thread_main, this);
+}
+
+Dad_prober::~Dad_prober() {
+  running = false;
+  poller.wake();
+  thread.join();
+  for (auto &request : pending) {
+    request.second.occupied.set_value(false);
+  }
+}
+
+void Dad_prober::answer(std::optional<Neighbor> const &neighbor) {
+  if (!neighbor.has_value()) {
+    return;
+  }
+  std::lock_guard<std::mutex> const lock{mutex};
+  for (auto request = std::begin(pending); request != std::end(pending);) {
+    auto &req = request->second;
+    if (req.ip != neighbor->ip || is_same_mac(req.own_mac, neighbor->mac)) {
+      ++request;
+      continue;
+    }
+    log(LOG_INFO, "%s is used by %s", req.ip.pure().c_str(),
+        binary_to_mac(neighbor->mac).c_str());
+    req.occupied.set_value(true);
+    request = pending.erase(request);
+  }
+}
+
+int Dad_prober::expire() {
+  std::lock_guard<std::mutex> const lock{mutex};
+  auto const now = Clock::now();
+  while (!deadlines.empty()) {
+    auto const [deadline, id] = deadlines.top();
+    auto const request = pending.find(id);
+    if (request == std::end(pending)) {
+      // already answered
+      deadlines.pop();
+      continue;
+    }
+    if (deadline > now) {
+      // round up, waking up early would just wait again
+      auto const wait =
+          std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+      return static_cast<int>(wait.count());
+    }
+    request->second.occupied.set_value(false);
+    pending.erase(request);
+    deadlines.pop();
+  }
+  return -1;
+}
+
+void Dad_prober::thread_main() {
+  try {
+    while (running) {
+      // probe() wakes the poller to get new deadlines into account
+      poller.poll(expire());
+    }
+  } catch (std::exception const &e) {
+    log(LOG_ERR, "Dad_prober stopped: %s", e.what());
+  }
+}
+
+std::future<bool> Dad_prober::probe(std::string const &iface,
+                                    IP_address const &ip,
+                                    ether_addr const &own_mac,
+                                    std::chrono::milliseconds const timeout) {
+  auto const ifindex = arp.get_ifindex(iface);
+  std::unique_lock<std::mutex> lock{mutex};
+  auto const id = next_id++;
+  auto const deadline = Clock::now() + timeout;
+  auto &request = pending
+                      .emplace(id, Request{.ip = ip.host(),
+                                           .own_mac = own_mac,
+                                           .deadline = deadline,
+                                           .occupied = {}})
+                      .first->second;
+  auto occupied = request.occupied.get_future();
+  try {
+    if (ip.family == AF_INET) {
+      arp.send_probe(ifindex, own_mac, ip);
+    } else {
+      ndp.send_solicitation(ifindex, own_mac, ip);
+    }
+  } catch (std::runtime_error const &e) {
+    log(LOG_ERR, "failed to probe %s: %s", ip.pure().c_str(), e.what());
+    request.occupied.set_value(false);
+    pending.erase(id);
+    return occupied;
+  }
+  deadlines.emplace(deadline, id);
+  lock.unlock();
+  poller.wake();
+  return occupied;
+}
@@ -15,104 +15,50 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 #include "duplicate_address_watcher.h"
-#include "container_utils.h"
+#include "ethernet.h"
 #include "log.h"
-#include "spawn_process.h"
-#include <algorithm>
-#include <cctype>
+#include "netlink.h"
+#include <iomanip>
+#include <sstream>
 
-namespace {
-std::vector<std::string> get_cmd_ipv4() {
-  return std::vector<std::string>{"arping", "-q", "-D", "-c", "1", "-I"};
+Dad_prober &get_dad_prober() {
+  static Dad_prober prober;
+  return prober;
 }
 
-std::vector<std::string> get_cmd_ipv6() {
-  return std::vector<std::string>{"ndisc6", "-q", "-n", "-m"};
-}
-} // namespace
-
-bool contains_mac_different_from_given(std::string mac,
-                                       std::vector<std::string> const &lines) {
-  auto const transform_to_upper = [](std::string tmp) {
-    std::ranges::transform(tmp, std::begin(tmp), ::toupper);
-    return tmp;
-  };
-
-  auto const macs_are_not_equal = [&](std::string const &line) {
-    return transform_to_upper(line) != mac;
-  };
-
-  mac = transform_to_upper(mac);
-
-  return std::ranges::any_of(lines, macs_are_not_equal);
+Neighbor_watcher &get_neighbor_watcher() {
+  static Neighbor_watcher watcher;
+  return watcher;
 }
 
 std::string get_mac(std::string const &iface) {
-  auto const cmd = std::vector<std::string>{"ip", "a", "show", "dev", iface};
-  auto const out_in = get_self_pipes(false);
-  auto const status = spawn(cmd, File_descriptor(), std::get<1>(out_in));
-  if (status != 0) {
-    throw std::runtime_error(std::string("get_mac(): ip a show dev ") + iface +
-                             " did not succeed");
+  auto const mac = Netlink_socket{}.get_link(iface).address;
+  std::ostringstream formatted;
+  formatted << std::hex << std::setfill('0');
+  std::string separator;
+  for (auto const byte : mac.ether_addr_octet) {
+    formatted << separator << std::setw(2) << static_cast<unsigned int>(byte);
+    separator = ":";
   }
-  auto const lines = std::get<0>(out_in).read();
-  static auto const mac_row = uint8_t{1};
-  auto const &line = lines.at(mac_row);
-  auto const splitted_line = split(line, ' ');
-  static auto const mac_column = uint8_t{5};
-  return splitted_line.at(mac_column);
+  return formatted.str();
 }
 
 Ip_neigh_checker::Ip_neigh_checker(std::string mac)
     : this_nodes_mac{std::move(mac)} {}
 
-bool Ip_neigh_checker::is_ipv4_present(std::string const &iface,
-                                       IP_address const &ip) {
-  auto cmd_ipv4_tmp = get_cmd_ipv4();
-  cmd_ipv4_tmp.push_back(iface);
-  cmd_ipv4_tmp.push_back(ip.pure());
-  auto const status = spawn(cmd_ipv4_tmp);
-  // if arping detects duplicate address, it returns 1
-  return status == 1;
-}
-
-bool Ip_neigh_checker::is_ipv6_present(std::string const &iface,
-                                       IP_address const &ip) const {
-  // when multiple nodes have the same ipv6 address
-  // lutz@barcas:~/workspace/sleep-proxy$ ndisc6 -q -n -m fe80::123 wlan0
-  // A0:88:B4:CF:50:94
-  // 22:4E:7F:6F:78:F1
-  // ...
-  // openwrt handles this differently, and outputs only foreign MACs with an
-  // error code. to be able to do tests, I have to check the output if there
-  // are foreign macs in it
-  auto cmd_ipv6_tmp = get_cmd_ipv6();
-  cmd_ipv6_tmp.push_back(ip.pure());
-  cmd_ipv6_tmp.push_back(iface);
-
-  auto const out_in = get_self_pipes(false);
-
-  spawn(cmd_ipv6_tmp, File_descriptor(), std::get<1>(out_in));
-
-  // if there are more than one line, there must be another host
-  // one line is this programm/node
-  return contains_mac_different_from_given(this_nodes_mac,
-                                           std::get<0>(out_in).read());
-}
-
 bool Ip_neigh_checker::operator()(std::string const &iface,
                                   IP_address const &ip) const {
-  if (ip.family == AF_INET) {
-    return is_ipv4_present(iface, ip);
-  }
-  return is_ipv6_present(iface, ip);
+  // replies from this node do not count
+  return get_dad_prober()
+      .probe(iface, ip, mac_to_binary(this_nodes_mac))
+      .get();
 }
 
 void daw_thread_main_non_root(const std::string &iface, const IP_address &ip,
                               Is_ip_occupied const &is_ip_occupied,
                               std::atomic<bool> &loop, Pcap_wrapper &pc) {
   // 2. while(loop)
-  // 2.1 use 'ip neigh' to watch for neighbors with the same ip
+  // 2.1 probe for neighbors with the same ip
   // 2.2 if someone uses ip
   // 2.2.1 loop = false
   // 2.2.2 pc.break_loop
@@ -125,8 +71,16 @@ void daw_thread_main_non_root(const std::string &iface, const IP_address &ip,
         loop = false;
         pc.break_loop(Pcap_wrapper::Loop_end_reason::duplicate_address);
       } else {
-        static auto const check_intervall = std::chrono::milliseconds(1000);
-        std::this_thread::sleep_for(check_intervall);
+        // the capture and the neighbor watcher notice other nodes at once,
+        // probing only catches what they missed
+        static auto const check_intervall = std::chrono::seconds(10);
+        static auto const stop_check_intervall =
+            std::chrono::milliseconds(100);
+        auto const next_check =
+            std::chrono::steady_clock::now() + check_intervall;
+        while (loop && std::chrono::steady_clock::now() < next_check) {
+          std::this_thread::sleep_for(stop_check_intervall);
+        }
       }
     }
   } catch (std::exception const &e) {
@@ -138,10 +92,12 @@ void daw_thread_main_non_root(const std::string &iface, const IP_address &ip,
 
 void daw_thread_main_ipv6(const std::string &iface, const IP_address &ip,
                           Is_ip_occupied const &is_ip_occupied,
-                          std::atomic<bool> &loop, Pcap_wrapper &pc) {
+                          std::atomic<bool> &loop, Pcap_wrapper &pc,
+                          Firewall_backend const firewall) {
   // 1. block incoming duplicate address detection for ip using firewall
   try {
-    Scope_guard const bipv6ns{Block_ipv6_neighbor_solicitation{ip}};
+    Scope_guard const bipv6ns{firewall_transaction(
+        firewall, {Block_ipv6_neighbor_solicitation{ip}})};
     daw_thread_main_non_root(iface, ip, is_ip_occupied, loop, pc);
   } catch (std::exception const &e) {
     log(LOG_INFO, "daw_thread_main_ipv6 got exception: %s", e.what());
@@ -150,18 +106,19 @@ void daw_thread_main_ipv6(const std::string &iface, const IP_address &ip,
   }
 }
 
-Duplicate_address_watcher::Duplicate_address_watcher(std::string ifacee,
-                                                     const IP_address ipp,
-                                                     Pcap_wrapper &pc)
+Duplicate_address_watcher::Duplicate_address_watcher(
+    std::string ifacee, const IP_address ipp, Pcap_wrapper &pc,
+    Firewall_backend const firewalll)
     : iface(std::move(ifacee)), ip(ipp), pcap(pc),
-      is_ip_occupied{Ip_neigh_checker{get_mac(iface)}}, watcher(), loop{false} {
-}
+      is_ip_occupied{Ip_neigh_checker{get_mac(iface)}}, firewall{firewalll},
+      watcher(), loop{false}, neighbor_watch{} {}
 
 Duplicate_address_watcher::Duplicate_address_watcher(
     std::string ifacee, const IP_address ipp, Pcap_wrapper &pc,
-    Is_ip_occupied is_ip_occupiedd)
+    Is_ip_occupied is_ip_occupiedd, Firewall_backend const firewalll)
     : iface(std::move(ifacee)), ip(ipp), pcap(pc),
-      is_ip_occupied{std::move(is_ip_occupiedd)}, watcher(), loop{false} {}
+      is_ip_occupied{std::move(is_ip_occupiedd)}, firewall{firewalll},
+      watcher(), loop{false}, neighbor_watch{} {}
 
 Duplicate_address_watcher::~Duplicate_address_watcher() { stop_watcher(); }
 
@@ -171,11 +128,29 @@ using Main_Function_Type = std::function<void(
 
 std::string Duplicate_address_watcher::operator()(const Action action) {
   Main_Function_Type const main_function =
-      ip.family == AF_INET ? daw_thread_main_non_root : daw_thread_main_ipv6;
+      ip.family == AF_INET
+          ? Main_Function_Type{daw_thread_main_non_root}
+          : Main_Function_Type{[backend = firewall](
+                                   const std::string &ifacee,
+                                   const IP_address &ipp,
+                                   Is_ip_occupied const &is_ip_occupiedd,
+                                   std::atomic<bool> &loopp, Pcap_wrapper &pc) {
+              daw_thread_main_ipv6(ifacee, ipp, is_ip_occupiedd, loopp, pc,
+                                   backend);
+            }};
 
   if (Action::add == action) {
     log(LOG_INFO, "starting Duplicate_address_watcher for IP %s",
         ip.with_subnet().c_str());
+    try {
+      neighbor_watch = get_neighbor_watcher().watch(
+          iface, ip, [&pc = pcap](Neighbor const & /*unused*/) {
+            pc.break_loop(Pcap_wrapper::Loop_end_reason::duplicate_address);
+          });
+    } catch (std::runtime_error const &e) {
+      log(LOG_ERR, "not watching the neighbors of %s: %s", iface.c_str(),
+          e.what());
+    }
     loop = true;
     watcher = std::thread(main_function, iface, ip, is_ip_occupied,
                           std::ref(loop), std::ref(pcap));
@@ -189,6 +164,10 @@ std::string Duplicate_address_watcher::operator()(const Action action) {
 }
 
 void Duplicate_address_watcher::stop_watcher() {
+  if (neighbor_watch.has_value()) {
+    get_neighbor_watcher().unwatch(*neighbor_watch);
+    neighbor_watch.reset();
+  }
   loop = false;
   if (watcher.joinable()) {
     watcher.join();
@@ -19,8 +19,10 @@
 #include <stdexcept>
 
 uint8_t const Link_layer::lcc_header_size;
+uint8_t const Link_layer::lcc2_header_size;
 uint8_t const Link_layer::lcc_address_size;
 uint8_t const Link_layer::ethernet_header_size;
+uint8_t const Link_layer::vlan_header_size;
 uint16_t const Link_layer::ETHERTYPE_WAKE_ON_LAN;
 
 std::ostream &operator<<(std::ostream &out, const Link_layer &ll) {
@@ -28,16 +30,31 @@ std::ostream &operator<<(std::ostream &out, const Link_layer &ll) {
   return out;
 }
 
-Link_layer::Link_layer(size_t const header_length, ether_addr const source,
-                       uint16_t const payload_protocol, std::string info)
-    : m_header_length(header_length), m_source(source),
-      m_payload_protocol(payload_protocol), m_info(std::move(info)) {}
+Link_layer::Link_layer(Type const type, size_t const header_length,
+                       ether_addr const source, uint16_t const payload_protocol,
+                       ether_addr const destination)
+    : m_type(type), m_header_length(header_length), m_source(source),
+      m_destination(destination), m_payload_protocol(payload_protocol) {}
+
+Link_layer::Type Link_layer::type() const { return m_type; }
 
 size_t Link_layer::header_length() const { return m_header_length; }
 
 uint16_t Link_layer::payload_protocol() const { return m_payload_protocol; }
 
-std::string Link_layer::get_info() const { return m_info; }
+std::string Link_layer::get_info() const {
+  switch (m_type) {
+  case Type::ethernet:
+    return "Ethernet: dst = " + binary_to_mac(m_destination) +
+           ", src = " + binary_to_mac(m_source);
+  case Type::linux_cooked_capture:
+    return "Linux cooked capture: src: " + binary_to_mac(m_source);
+  case Type::vlan:
+    return "VLAN Header";
+  default:
+    return "unknown link layer";
+  }
+}
 
 ether_addr Link_layer::source() const { return m_source; }
 
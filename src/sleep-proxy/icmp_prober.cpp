@@ -0,0 +1,279 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "icmp_prober.h"
+#include "log.h"
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <netinet/icmp6.h>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace {
+auto const echo_header_size = size_t{8};
+// netinet/ip_icmp.h clashes with struct ip
+auto const icmp_echo_reply = uint8_t{0};
+auto const icmp_echo_request = uint8_t{8};
+
+/** the internet checksum of RFC 1071 */
+uint16_t get_checksum(std::span<uint8_t const> const data) {
+  uint32_t sum = 0;
+  for (size_t i = 0; i + 1 < data.size(); i += 2) {
+    // NOLINTNEXTLINE
+    sum += static_cast<uint32_t>(data[i] << 8U | data[i + 1]);
+  }
+  if (data.size() % 2 == 1) {
+    // NOLINTNEXTLINE
+    sum += static_cast<uint32_t>(data.back() << 8U);
+  }
+  // NOLINTNEXTLINE
+  while (sum >> 16U != 0) {
+    // NOLINTNEXTLINE
+    sum = (sum & 0xffffU) + (sum >> 16U);
+  }
+  return static_cast<uint16_t>(~sum);
+}
+
+uint16_t get_uint16(std::span<uint8_t const> const data, size_t const pos) {
+  // NOLINTNEXTLINE
+  return static_cast<uint16_t>(data[pos] << 8U | data[pos + 1]);
+}
+
+int get_protocol(int const family) {
+  return family == AF_INET ? int{IPPROTO_ICMP} : int{IPPROTO_ICMPV6};
+}
+} // namespace
+
+std::vector<uint8_t> create_echo_request(int const family,
+                                         Echo_id const &echo) {
+  // NOLINTBEGIN
+  std::vector<uint8_t> request{
+      family == AF_INET ? icmp_echo_request : uint8_t{ICMP6_ECHO_REQUEST},
+      0,
+      0,
+      0,
+      static_cast<uint8_t>(echo.id >> 8U),
+      static_cast<uint8_t>(echo.id & 0xffU),
+      static_cast<uint8_t>(echo.sequence >> 8U),
+      static_cast<uint8_t>(echo.sequence & 0xffU)};
+  if (family == AF_INET) {
+    auto const checksum = get_checksum(request);
+    request.at(2) = static_cast<uint8_t>(checksum >> 8U);
+    request.at(3) = static_cast<uint8_t>(checksum & 0xffU);
+  }
+  // NOLINTEND
+  return request;
+}
+
+std::optional<Echo_id> parse_echo_reply(int const family,
+                                        std::span<uint8_t const> data) {
+  if (family == AF_INET) {
+    // skip the IP header
+    // NOLINTNEXTLINE
+    if (data.empty() || data[0] >> 4U != 4) {
+      return std::nullopt;
+    }
+    // NOLINTNEXTLINE
+    size_t const header_length = (data[0] & 0x0fU) * 4U;
+    if (data.size() < header_length) {
+      return std::nullopt;
+    }
+    data = data.subspan(header_length);
+  }
+  auto const reply_type =
+      family == AF_INET ? icmp_echo_reply : uint8_t{ICMP6_ECHO_REPLY};
+  if (data.size() < echo_header_size || data[0] != reply_type ||
+      data[1] != 0) {
+    return std::nullopt;
+  }
+  return Echo_id{.id = get_uint16(data, 4), .sequence = get_uint16(data, 6)};
+}
+
+Icmp_socket::Icmp_socket(int const familyy)
+    : Socket{familyy, SOCK_RAW | SOCK_NONBLOCK | SOCK_CLOEXEC,
+             get_protocol(familyy)},
+      family{familyy} {
+  if (family == AF_INET6) {
+    icmp6_filter filter{};
+    ICMP6_FILTER_SETBLOCKALL(&filter);
+    ICMP6_FILTER_SETPASS(ICMP6_ECHO_REPLY, &filter);
+    set_sock_opt(IPPROTO_ICMPV6, ICMP6_FILTER, filter);
+  }
+}
+
+void Icmp_socket::send_echo_request(IP_address const &ip, uint32_t const scope,
+                                    Echo_id const &echo) {
+  auto const request = create_echo_request(family, echo);
+  if (family == AF_INET) {
+    sockaddr_in const destination{.sin_family = AF_INET,
+                                  .sin_port = 0,
+                                  .sin_addr = ip.address.ipv4,
+                                  .sin_zero = {0}};
+    send_to(request, 0, destination);
+  } else {
+    sockaddr_in6 const destination{.sin6_family = AF_INET6,
+                                   .sin6_port = 0,
+                                   .sin6_flowinfo = 0,
+                                   .sin6_addr = ip.address.ipv6,
+                                   .sin6_scope_id = scope};
+    send_to(request, 0, destination);
+  }
+}
+
+std::optional<std::pair<Echo_id, IP_address>>
+Icmp_socket::receive_echo_reply() {
+  static auto const max_packet_size = size_t{1500};
+  std::array<uint8_t, max_packet_size> buffer{};
+  sockaddr_storage source{};
+  socklen_t source_length = sizeof(source);
+  auto const received = recvfrom(
+      fd(), buffer.data(), buffer.size(), 0,
+      // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+      reinterpret_cast<sockaddr *>(&source), &source_length);
+  if (received == -1) {
+    if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+      log_string(LOG_ERR,
+                 std::string("recvfrom() failed: ") + strerror(errno));
+    }
+    return std::nullopt;
+  }
+  auto const echo = parse_echo_reply(
+      family, std::span{buffer}.first(static_cast<size_t>(received)));
+  if (!echo.has_value()) {
+    return std::nullopt;
+  }
+  if (family == AF_INET) {
+    sockaddr_in source_ipv4{};
+    std::memcpy(&source_ipv4, &source, sizeof(source_ipv4));
+    static auto const no_subnet = uint8_t{32};
+    return std::make_pair(*echo, IP_address{.family = AF_INET,
+                                            .address = {source_ipv4.sin_addr},
+                                            .subnet = no_subnet});
+  }
+  sockaddr_in6 source_ipv6{};
+  std::memcpy(&source_ipv6, &source, sizeof(source_ipv6));
+  static auto const all_bits_specified = uint8_t{128};
+  IP_address ipa{};
+  ipa.family = AF_INET6;
+  // NOLINTNEXTLINE
+  ipa.address.ipv6 = source_ipv6.sin6_addr;
+  ipa.subnet = all_bits_specified;
+  return std::make_pair(*echo, ipa);
+}
+
+Icmp_prober::Icmp_prober()
+    : id{static_cast<uint16_t>(getpid())}, icmp{AF_INET}, icmp6{AF_INET6},
+      poller{}, mutex{}, next_sequence{0}, pending{}, deadlines{},
+      running{true}, thread{} {
+  poller.add(icmp.fd(), [this] { receive(icmp); });
+  poller.add(icmp6.fd(), [this] { receive(icmp6); });
+  thread = std::thread(&Icmp_prober::thread_main, this);
+}
+
+Icmp_prober::~Icmp_prober() {
+  running = false;
+  poller.wake();
+  thread.join();
+  for (auto &request : pending) {
+    request.second.alive.set_value(false);
+  }
+}
+
+void Icmp_prober::receive(Icmp_socket &sock) {
+  auto const reply = sock.receive_echo_reply();
+  if (!reply.has_value() || reply->first.id != id) {
+    return;
+  }
+  std::lock_guard<std::mutex> const lock{mutex};
+  auto const request = pending.find(reply->first.sequence);
+  if (request != std::end(pending) &&
+      request->second.destination == reply->second) {
+    request->second.alive.set_value(true);
+    pending.erase(request);
+  }
+}
+
+int Icmp_prober::expire() {
+  std::lock_guard<std::mutex> const lock{mutex};
+  auto const now = Clock::now();
+  while (!deadlines.empty()) {
+    auto const [deadline, sequence] = deadlines.top();
+    auto const request = pending.find(sequence);
+    if (request == std::end(pending) || request->second.deadline != deadline) {
+      // already answered
+      deadlines.pop();
+      continue;
+    }
+    if (deadline > now) {
+      // round up, waking up early would just wait again
+      auto const wait =
+          std::chrono::ceil<std::chrono::milliseconds>(deadline - now);
+      return static_cast<int>(wait.count());
+    }
+    request->second.alive.set_value(false);
+    pending.erase(request);
+    deadlines.pop();
+  }
+  return -1;
+}
+
+void Icmp_prober::thread_main() {
+  try {
+    while (running) {
+      // probe() wakes the poller to get new deadlines into account
+      poller.poll(expire());
+    }
+  } catch (std::exception const &e) {
+    log(LOG_ERR, "Icmp_prober stopped: %s", e.what());
+  }
+}
+
+std::future<bool> Icmp_prober::probe(std::string const &iface,
+                                     IP_address const &ip,
+                                     std::chrono::milliseconds const timeout) {
+  auto &sock = ip.family == AF_INET ? icmp : icmp6;
+  // NOLINTNEXTLINE
+  uint32_t const scope = ip.family == AF_INET6 &&
+                                 IN6_IS_ADDR_LINKLOCAL(&ip.address.ipv6)
+                             ? static_cast<uint32_t>(sock.get_ifindex(iface))
+                             : 0;
+  std::unique_lock<std::mutex> lock{mutex};
+  while (pending.contains(next_sequence)) {
+    next_sequence++;
+  }
+  auto const sequence = next_sequence++;
+  auto const deadline = Clock::now() + timeout;
+  auto &request =
+      pending
+          .emplace(sequence, Request{.destination = ip.host(),
+                                     .deadline = deadline,
+                                     .alive = {}})
+          .first->second;
+  auto alive = request.alive.get_future();
+  try {
+    sock.send_echo_request(ip, scope, Echo_id{.id = id, .sequence = sequence});
+  } catch (std::runtime_error const &e) {
+    log(LOG_ERR, "failed to ping %s: %s", ip.pure().c_str(), e.what());
+    request.alive.set_value(false);
+    pending.erase(sequence);
+    return alive;
+  }
+  deadlines.emplace(deadline, sequence);
+  lock.unlock();
+  poller.wake();
+  return alive;
+}
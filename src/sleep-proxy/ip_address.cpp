@@ -19,7 +19,9 @@
 #include "int_utils.h"
 #include "log.h"
 #include "to_string.h"
+#include <algorithm>
 #include <array>
+#include <cstring>
 
 namespace {
 int get_af(const std::string &ip) {
@@ -45,6 +47,12 @@ uint8_t get_std_subnet(const int version,
   return ipv4_subnet;
 }
 
+uint8_t get_max_subnet(const int version) {
+  static auto const ipv4_max_subnet = uint8_t{32};
+  static auto const ipv6_max_subnet = uint8_t{128};
+  return version == AF_INET ? ipv4_max_subnet : ipv6_max_subnet;
+}
+
 uint8_t get_subnet(const int version,
                    const std::vector<std::string> &ip_subnet) {
   // if no subnet size is given, append standard values
@@ -53,7 +61,7 @@ uint8_t get_subnet(const int version,
                              : get_std_subnet(version, ip_subnet);
 
   // check if the subnet size is in correct bounds
-  const uint8_t maxsubnetlen = version == AF_INET ? 32 : 128;
+  const uint8_t maxsubnetlen = get_max_subnet(version);
   if (subnet > maxsubnetlen) {
     std::string ss = "Subnet " + to_string(subnet) + " is not in range 0.." +
                      to_string(maxsubnetlen);
@@ -61,6 +69,18 @@ uint8_t get_subnet(const int version,
   }
   return subnet;
 }
+
+/** finalizer of MurmurHash3, every input bit affects every output bit */
+uint64_t mix(uint64_t value) {
+  // NOLINTBEGIN
+  value ^= value >> 33U;
+  value *= 0xff51afd7ed558ccdULL;
+  value ^= value >> 33U;
+  value *= 0xc4ceb9fe1a85ec53ULL;
+  value ^= value >> 33U;
+  // NOLINTEND
+  return value;
+}
 } // namespace
 
 std::string IP_address::pure() const {
@@ -75,11 +95,47 @@ std::string IP_address::with_subnet() const {
   return pure() + "/" + to_string(static_cast<int>(subnet));
 }
 
+std::span<uint8_t const> IP_address::bytes() const {
+  static auto const ipv4_size = size_t{4};
+  static auto const ipv6_size = size_t{16};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return {reinterpret_cast<uint8_t const *>(&address),
+          family == AF_INET ? ipv4_size : ipv6_size};
+}
+
+IP_address IP_address::host() const {
+  IP_address ipa{*this};
+  ipa.subnet = get_max_subnet(family);
+  return ipa;
+}
+
 bool IP_address::operator==(const IP_address &rhs) const {
-  bool equal = family == rhs.family;
-  equal &= subnet == rhs.subnet;
-  equal &= pure() == rhs.pure();
-  return equal;
+  return family == rhs.family && subnet == rhs.subnet &&
+         std::ranges::equal(bytes(), rhs.bytes());
+}
+
+std::strong_ordering IP_address::operator<=>(const IP_address &rhs) const {
+  if (auto const cmp = family <=> rhs.family; cmp != 0) {
+    return cmp;
+  }
+  auto const lhs_bytes = bytes();
+  auto const rhs_bytes = rhs.bytes();
+  if (auto const cmp = std::lexicographical_compare_three_way(
+          std::begin(lhs_bytes), std::end(lhs_bytes), std::begin(rhs_bytes),
+          std::end(rhs_bytes));
+      cmp != 0) {
+    return cmp;
+  }
+  return subnet <=> rhs.subnet;
+}
+
+size_t std::hash<IP_address>::operator()(const IP_address &ipa) const noexcept {
+  std::array<uint64_t, 2> words{};
+  auto const bytes = ipa.bytes();
+  std::memcpy(words.data(), bytes.data(), bytes.size());
+  auto const family_and_subnet =
+      static_cast<uint64_t>(ipa.family) << 8U | ipa.subnet;
+  return mix(words.at(0) ^ mix(words.at(1) ^ mix(family_and_subnet)));
 }
 
 static const std::string ip_chars{
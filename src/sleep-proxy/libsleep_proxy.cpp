@@ -16,21 +16,31 @@
 
 #include "libsleep_proxy.h"
 #include "args.h"
+#include "capture_engine.h"
 #include "container_utils.h"
+#include "dad_prober.h"
 #include "duplicate_address_watcher.h"
+#include "icmp_prober.h"
 #include "log.h"
 #include "packet_parser.h"
 #include "pcap_wrapper.h"
 #include "scope_guard.h"
-#include "spawn_process.h"
 #include "wol.h"
 #include "wol_watcher.h"
+#include <algorithm>
 #include <atomic>
 #include <csignal>
+#include <chrono>
 #include <cstring>
+#include <future>
+#include <iomanip>
+#include <iterator>
 #include <mutex>
+#include <optional>
+#include <sstream>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <tuple>
 #include <vector>
 
@@ -74,47 +84,56 @@ void set_signal(const int signum, const struct sigaction &sa) {
  */
 std::vector<Scope_guard> setup_firewall_and_ips(const Host_args &args) {
   std::vector<Scope_guard> guards;
+  // setup firewall first, some services might respond
+  // reject any incoming connection, except the ones to the
+  // ports specified. the rules of all ips are changed at once
+  std::vector<Firewall_rule> rules;
   for (auto const &ip : args.address) {
-    // setup firewall first, some services might respond
-    // reject any incoming connection, except the ones to the
-    // ports specified
-    guards.emplace_back(Reject_tp{.ip = ip, .tcp_udp = Reject_tp::TP::TCP});
-    guards.emplace_back(Reject_tp{.ip = ip, .tcp_udp = Reject_tp::TP::UDP});
+    rules.emplace_back(Reject_tp{.ip = ip, .tcp_udp = Reject_tp::TP::TCP});
+    rules.emplace_back(Reject_tp{.ip = ip, .tcp_udp = Reject_tp::TP::UDP});
     for (auto const &port : args.ports) {
-      guards.emplace_back(Drop_port{.ip = ip, .port = port});
+      rules.emplace_back(Drop_port{.ip = ip, .port = port});
     }
-    guards.emplace_back(Temp_ip{.iface = args.interface, .ip = ip});
   }
+  guards.emplace_back(firewall_transaction(args.firewall, std::move(rules)));
+  // all addresses are added with a single netlink round trip
+  guards.emplace_back(Temp_ips{.iface = args.interface, .ips = args.address});
   return guards;
 }
 
 /**
  * Waits and blocks until a SYN packet to any of the given IPs in Args and to
- * any of the given ports in Args is received. Returns the data, the IP
+ * any of the given ports in Args is received by pc. Returns the data, the IP
  * source of the received packet and the destination IP
  */
 std::tuple<Pcap_wrapper::Loop_end_reason, std::vector<uint8_t>, IP_address,
            IP_address>
-wait_and_listen(const Host_args &args) {
-  Pcap_wrapper pc("any");
-
+wait_and_listen(const Host_args &args, Pcap_wrapper &pc) {
   // guards to handle signals and address duplication
   std::vector<Scope_guard> guards;
-  guards.emplace_back(
-      make_copyable<Wol_watcher>(args.interface, args.mac, std::ref(pc)));
   guards.emplace_back(ptr_guard(pcaps, pcaps_mutex, pc));
   for (const auto &ip : args.address) {
     guards.emplace_back(make_copyable<Duplicate_address_watcher>(
-        args.interface, ip, std::ref(pc)));
+        args.interface, ip, std::ref(pc), args.firewall));
   }
 
-  const std::string bpf =
-      rule_to_listen_on_ips_and_ports(args.address, args.ports);
-  log_string(LOG_INFO, "Listening with filter: " + bpf);
-  pc.set_filter(bpf);
-
+  // a returning host announcing one of the addresses ends the wait at once
   Catch_incoming_connection catcher(pc.get_datalink());
-  const Pcap_wrapper::Loop_end_reason ler = pc.loop(1, std::ref(catcher));
+  std::optional<Neighbor> claim;
+  auto const catch_or_claim = [&](const pcap_pkthdr *header,
+                                  const u_char *packet) {
+    catcher(header, packet);
+    if (header != nullptr && packet != nullptr) {
+      claim = get_address_claim(catcher.headers,
+                                to_packet_view(*header, packet));
+    }
+  };
+  Pcap_wrapper::Loop_end_reason ler = pc.loop(1, catch_or_claim);
+  if (claim.has_value()) {
+    log(LOG_INFO, "%s claims %s", binary_to_mac(claim->mac).c_str(),
+        claim->ip.pure().c_str());
+    ler = Pcap_wrapper::Loop_end_reason::duplicate_address;
+  }
 
   // check if address duplication got something
   switch (ler) {
@@ -141,7 +160,7 @@ wait_and_listen(const Host_args &args) {
 
   log_string(LOG_INFO, "catched headers: " + to_string(catcher.headers));
 
-  if (std::get<1>(catcher.headers) == nullptr) {
+  if (!std::get<1>(catcher.headers).has_value()) {
     log_string(LOG_INFO, "got nothing while catching with pcap");
     if (Pcap_wrapper::Loop_end_reason::packets_captured == ler) {
       throw std::runtime_error(
@@ -155,18 +174,33 @@ wait_and_listen(const Host_args &args) {
                          std::get<1>(catcher.headers)->destination());
 }
 
-std::string get_ping_cmd(const IP_address &ip) {
-  std::string pingcmd = ip.family == AF_INET ? "ping" : "ping6";
-  return pingcmd;
+/**
+ * Same as above, but opens its own pcap handle and watches for magic packets
+ * sent by someone else
+ */
+std::tuple<Pcap_wrapper::Loop_end_reason, std::vector<uint8_t>, IP_address,
+           IP_address>
+wait_and_listen(const Host_args &args) {
+  Pcap_wrapper pc("any", Ring_config{});
+  Scope_guard const wol_watcher{
+      make_copyable<Wol_watcher>(args.interface, args.mac, std::ref(pc))};
+
+  const std::string bpf =
+      "(" + rule_to_listen_on_ips_and_ports(args.address, args.ports) +
+      ") or (" + rule_to_listen_on_address_claims(args.address) + ")";
+  log_string(LOG_INFO, "Listening with filter: " + bpf);
+  pc.set_filter(bpf);
+
+  return wait_and_listen(args, pc);
 }
 
 void replay_data(const std::string &iface, const int type,
                  const std::vector<uint8_t> &data,
                  const ether_addr &target_mac) {
   log_string(LOG_INFO, "replaing SYN packet");
-  basic_headers headers = get_headers(type, data);
-  const std::unique_ptr<Link_layer> &ll = std::get<0>(headers);
-  if (ll == nullptr) {
+  basic_headers const headers = get_headers(type, data);
+  auto const &ll = std::get<0>(headers);
+  if (!ll.has_value() || !std::get<1>(headers).has_value()) {
     return;
   }
   const uint16_t payload_type = std::get<1>(headers)->version();
@@ -203,6 +237,46 @@ rule_to_listen_on_ips_and_ports(const std::vector<IP_address> &ips,
   return bpf;
 }
 
+std::string
+rule_to_listen_on_address_claims(const std::vector<IP_address> &ips) {
+  std::vector<IP_address> ipv4;
+  std::vector<IP_address> ipv6;
+  std::ranges::partition_copy(
+      ips, std::back_inserter(ipv4), std::back_inserter(ipv6),
+      [](IP_address const &ip) { return ip.family == AF_INET; });
+  // the target of the advertisement is compared in words of 4 bytes
+  auto const match_target = [](IP_address const &ip) {
+    static auto const target_offset = size_t{48};
+    static auto const word_size = size_t{4};
+    auto const bytes = ip.bytes();
+    std::ostringstream match;
+    match << std::hex << std::setfill('0');
+    std::string separator = "(";
+    for (size_t i = 0; i < bytes.size(); i += word_size) {
+      match << separator << "ip6[" << std::dec << target_offset + i << ":"
+            << word_size << "] = 0x" << std::hex;
+      for (auto const byte : bytes.subspan(i, word_size)) {
+        match << std::setw(2) << static_cast<unsigned int>(byte);
+      }
+      separator = " and ";
+    }
+    match << ")";
+    return match.str();
+  };
+  std::vector<std::string> claims;
+  if (!ipv4.empty()) {
+    claims.emplace_back("arp src host (" + join(ipv4, get_pure_ip, " or ") +
+                        ")");
+  }
+  if (!ipv6.empty()) {
+    // extension headers are not expected in neighbor discovery
+    claims.emplace_back("(icmp6 and ip6[40] = 136 and (" +
+                        join(ipv6, match_target, " or ") + "))");
+  }
+  // the kernel answers for the addresses as well, only others count
+  return "inbound and (" + join(claims, identity<std::string>, " or ") + ")";
+}
+
 std::string get_bindable_ip(const std::string &iface, const std::string &ip) {
   if (ip.starts_with("fe80")) {
     return ip + '%' + iface;
@@ -210,31 +284,71 @@ std::string get_bindable_ip(const std::string &iface, const std::string &ip) {
   return ip;
 }
 
+Icmp_prober &get_icmp_prober() {
+  static Icmp_prober prober;
+  return prober;
+}
+
 bool ping_and_wait(const std::string &iface, const IP_address &ip,
                    const unsigned int tries) {
-  const std::string ipcmd = get_ping_cmd(ip);
-  const std::string cmd{ipcmd + " -c 1 " + get_bindable_ip(iface, ip.pure())};
-  uint8_t ret_val = 1;
-  for (unsigned int i = 0; i < tries && !is_signaled() && ret_val != 0; i++) {
-    ret_val = spawn(split(cmd, ' '));
+  bool alive = false;
+  for (unsigned int i = 0; i < tries && !is_signaled() && !alive; i++) {
+    alive = get_icmp_prober().probe(iface, ip).get();
   }
-  if (ret_val != 0) {
+  if (!alive) {
     log(LOG_ERR, "failed to ping ip %s after %u ping attempts",
         ip.pure().c_str(), tries);
   }
-  return ret_val == 0;
+  return alive;
 }
 
+std::string get_host_up_filter(const ether_addr &mac) {
+  return "ether src " + binary_to_mac(mac);
+}
+
+bool wait_until_up(Pcap_wrapper &frames, const std::string &iface,
+                   const IP_address &ip, const unsigned int tries) {
+  Scope_guard const signal_guard{ptr_guard(pcaps, pcaps_mutex, frames)};
+  std::atomic<bool> seen{false};
+  std::thread capture{[&] {
+    auto const ler =
+        frames.loop(1, [](const pcap_pkthdr * /*unused*/,
+                          const u_char * /*unused*/) {});
+    seen = Pcap_wrapper::Loop_end_reason::packets_captured == ler;
+  }};
+  // ping in case no frame of the host gets captured
+  static auto const seen_check_interval = std::chrono::milliseconds(10);
+  bool alive = false;
+  for (unsigned int i = 0; i < tries && !is_signaled() && !seen && !alive;
+       i++) {
+    auto reply = get_icmp_prober().probe(iface, ip);
+    while (!seen && !is_signaled() &&
+           reply.wait_for(seen_check_interval) != std::future_status::ready) {
+    }
+    alive = !seen && !is_signaled() && reply.get();
+  }
+  frames.break_loop(Pcap_wrapper::Loop_end_reason::unset);
+  capture.join();
+  if (seen) {
+    log(LOG_INFO, "%s is up, captured a frame sent by it", ip.pure().c_str());
+  } else if (alive) {
+    log(LOG_INFO, "%s is up, it answered a ping", ip.pure().c_str());
+  } else {
+    log(LOG_ERR, "failed to see or ping ip %s after %u ping attempts",
+        ip.pure().c_str(), tries);
+  }
+  return seen || alive;
+}
+
+namespace {
 /**
- * Puts everything together. Sets up firewall and IPs. Waits for an incoming
- * SYN packet and wakes the sleeping host via WOL
+ * Wakes the sleeping host after wait_and_listen() received a SYN packet and
+ * replays the SYN packet, which has been captured with the given datalink
  */
-Emulate_host_status emulate_host(const Host_args &args) {
-  // setup firewall rules and add IPs to the interface
-  std::vector<Scope_guard> locks(setup_firewall_and_ips(args));
-  // wait until upon an incoming connection
-  const auto status_data_source_destination = wait_and_listen(args);
-
+Emulate_host_status wake_and_replay(
+    const Host_args &args, std::vector<Scope_guard> &locks, int const datalink,
+    std::tuple<Pcap_wrapper::Loop_end_reason, std::vector<uint8_t>, IP_address,
+               IP_address> const &status_data_source_destination) {
   switch (std::get<0>(status_data_source_destination)) {
   case Pcap_wrapper::Loop_end_reason::duplicate_address:
     return Emulate_host_status::duplicate_address;
@@ -255,10 +369,14 @@ Emulate_host_status emulate_host(const Host_args &args) {
 
   // block icmp messages to the source IP, e.g. not tell him that his
   // destination IP is gone for a short while
-  const Scope_guard block_icmp(
-      Block_icmp{std::get<2>(status_data_source_destination)});
+  const Scope_guard block_icmp(firewall_transaction(
+      args.firewall,
+      {Block_icmp{std::get<2>(status_data_source_destination)}}));
   // release_locks()
   locks.clear();
+  // capture from before waking, the first frames of the host might be early
+  Pcap_wrapper host_frames{args.interface};
+  host_frames.set_filter(get_host_up_filter(args.mac));
   // wake the sleeping server
   if (args.wol_method == Wol_method::udp) {
     wol_udp(args.mac);
@@ -266,18 +384,42 @@ Emulate_host_status emulate_host(const Host_args &args) {
     wol_ethernet(args.interface, args.mac);
   }
 
-  // wait until server responds and release ICMP rules
-  log_string(LOG_INFO,
-             "ping: " + std::get<3>(status_data_source_destination).pure());
-  const bool wake_success =
-      ping_and_wait(args.interface, std::get<3>(status_data_source_destination),
-                    args.ping_tries);
+  // wait until server sends something or responds and release ICMP rules
+  log_string(LOG_INFO, "waiting for: " +
+                           std::get<3>(status_data_source_destination).pure());
+  const bool wake_success = wait_until_up(
+      host_frames, args.interface, std::get<3>(status_data_source_destination),
+      args.ping_tries);
   const std::string status = wake_success ? " succeeded" : " failed";
   log_string(LOG_NOTICE, "waking " + args.hostname + " with mac " +
                              binary_to_mac(args.mac) + status);
   // replay SYN packet
-  replay_data(args.interface, DLT_LINUX_SLL,
+  replay_data(args.interface, datalink,
               std::get<1>(status_data_source_destination), args.mac);
   return wake_success ? Emulate_host_status::success
                       : Emulate_host_status::wake_failure;
 }
+} // namespace
+
+/**
+ * Puts everything together. Sets up firewall and IPs. Waits for an incoming
+ * SYN packet and wakes the sleeping host via WOL
+ */
+Emulate_host_status emulate_host(const Host_args &args) {
+  // setup firewall rules and add IPs to the interface
+  std::vector<Scope_guard> locks(setup_firewall_and_ips(args));
+  // wait until upon an incoming connection
+  const auto status_data_source_destination = wait_and_listen(args);
+  // pcap on "any" always delivers linux cooked captures
+  return wake_and_replay(args, locks, DLT_LINUX_SLL,
+                         status_data_source_destination);
+}
+
+Emulate_host_status emulate_host(const Host_args &args,
+                                 Host_capture &capture) {
+  capture.reset();
+  std::vector<Scope_guard> locks(setup_firewall_and_ips(args));
+  const auto status_data_source_destination = wait_and_listen(args, capture);
+  return wake_and_replay(args, locks, capture.get_datalink(),
+                         status_data_source_destination);
+}
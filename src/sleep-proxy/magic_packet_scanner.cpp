@@ -0,0 +1,204 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "magic_packet_scanner.h"
+#include <algorithm>
+#include <bit>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace {
+/** six 0xff followed by 16 times the mac */
+auto const sync_length = size_t{6};
+auto const mac_length = size_t{ETH_ALEN};
+auto const mac_repetitions = size_t{16};
+auto const magic_packet_size = sync_length + mac_repetitions * mac_length;
+auto const sync_byte = uint8_t{0xff};
+
+bool is_sync_byte(uint8_t const byte) { return byte == sync_byte; }
+
+size_t find_sync_stream_scalar(Packet_view const data, size_t const from,
+                               size_t const end) {
+  for (size_t i = from; i < end; i++) {
+    if (std::ranges::all_of(data.subspan(i, sync_length), is_sync_byte)) {
+      return i;
+    }
+  }
+  return data.size();
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// the vector loops compare sync_length overlapping loads with 0xff and AND
+// them together. a bit set in the result marks the start of six 0xff.
+// end is the last possible start plus one, so all loads stay within data.
+
+__attribute__((target("sse2"))) size_t
+find_sync_stream_sse2(Packet_view const data, size_t const from,
+                      size_t const end) {
+  static auto const width = size_t{16};
+  auto const ff = _mm_set1_epi8(-1);
+  size_t i = from;
+  for (; i + width <= end; i += width) {
+    // NOLINTNEXTLINE
+    auto const *const chunk = reinterpret_cast<__m128i const *>(&data[i]);
+    auto starts = _mm_cmpeq_epi8(_mm_loadu_si128(chunk), ff);
+    // most packets contain hardly any 0xff, no need to look further
+    if (_mm_movemask_epi8(starts) == 0) {
+      continue;
+    }
+    for (size_t k = 1; k < sync_length; k++) {
+      // NOLINTNEXTLINE
+      auto const *const next = reinterpret_cast<__m128i const *>(&data[i + k]);
+      auto const equal = _mm_cmpeq_epi8(_mm_loadu_si128(next), ff);
+      starts = _mm_and_si128(starts, equal);
+    }
+    auto const bits = static_cast<uint32_t>(_mm_movemask_epi8(starts));
+    if (bits != 0) {
+      return i + static_cast<size_t>(std::countr_zero(bits));
+    }
+  }
+  return find_sync_stream_scalar(data, i, end);
+}
+
+__attribute__((target("avx2"))) size_t
+find_sync_stream_avx2(Packet_view const data, size_t const from,
+                      size_t const end) {
+  static auto const width = size_t{32};
+  auto const ff = _mm256_set1_epi8(-1);
+  size_t i = from;
+  for (; i + width <= end; i += width) {
+    // NOLINTNEXTLINE
+    auto const *const chunk = reinterpret_cast<__m256i const *>(&data[i]);
+    auto starts = _mm256_cmpeq_epi8(_mm256_loadu_si256(chunk), ff);
+    if (_mm256_movemask_epi8(starts) == 0) {
+      continue;
+    }
+    for (size_t k = 1; k < sync_length; k++) {
+      // NOLINTNEXTLINE
+      auto const *const next = reinterpret_cast<__m256i const *>(&data[i + k]);
+      auto const equal = _mm256_cmpeq_epi8(_mm256_loadu_si256(next), ff);
+      starts = _mm256_and_si256(starts, equal);
+    }
+    auto const bits = static_cast<uint32_t>(_mm256_movemask_epi8(starts));
+    if (bits != 0) {
+      return i + static_cast<size_t>(std::countr_zero(bits));
+    }
+  }
+  // the tail call does not clear the upper halves of the registers, which
+  // makes the SSE instructions following it very slow
+  _mm256_zeroupper();
+  return find_sync_stream_sse2(data, i, end);
+}
+#endif
+
+uint64_t to_key(ether_addr const &mac) {
+  uint64_t key = 0;
+  for (auto const byte : mac.ether_addr_octet) {
+    key = key << 8U | byte;
+  }
+  return key;
+}
+} // namespace
+
+Simd_level best_simd_level() {
+#if defined(__x86_64__) || defined(__i386__)
+  static Simd_level const level = [] {
+    if (__builtin_cpu_supports("avx2") != 0) {
+      return Simd_level::avx2;
+    }
+    if (__builtin_cpu_supports("sse2") != 0) {
+      return Simd_level::sse2;
+    }
+    return Simd_level::scalar;
+  }();
+  return level;
+#else
+  return Simd_level::scalar;
+#endif
+}
+
+size_t find_sync_stream(Packet_view const data, size_t const from,
+                        Simd_level const level) {
+  if (data.size() < magic_packet_size) {
+    return data.size();
+  }
+  auto const end = data.size() - magic_packet_size + 1;
+  if (from >= end) {
+    return data.size();
+  }
+  switch (level) {
+#if defined(__x86_64__) || defined(__i386__)
+  case Simd_level::avx2:
+    return find_sync_stream_avx2(data, from, end);
+  case Simd_level::sse2:
+    return find_sync_stream_sse2(data, from, end);
+#endif
+  case Simd_level::scalar:
+  default:
+    return find_sync_stream_scalar(data, from, end);
+  }
+}
+
+size_t find_sync_stream(Packet_view const data, size_t const from) {
+  return find_sync_stream(data, from, best_simd_level());
+}
+
+std::optional<ether_addr> magic_packet_mac(Packet_view const data,
+                                           size_t const sync) {
+  if (sync > data.size() || data.size() - sync < magic_packet_size) {
+    return std::nullopt;
+  }
+  auto const packet = data.subspan(sync, magic_packet_size);
+  if (!std::ranges::all_of(packet.first(sync_length), is_sync_byte)) {
+    return std::nullopt;
+  }
+  auto const mac = packet.subspan(sync_length, mac_length);
+  for (size_t i = 1; i < mac_repetitions; i++) {
+    if (!std::ranges::equal(
+            mac, packet.subspan(sync_length + i * mac_length, mac_length))) {
+      return std::nullopt;
+    }
+  }
+  ether_addr result{};
+  std::ranges::copy(mac, std::begin(result.ether_addr_octet));
+  return result;
+}
+
+Magic_packet_scanner::Magic_packet_scanner(std::vector<ether_addr> const &macs,
+                                           Simd_level const levell)
+    : hosts{}, level{levell} {
+  for (size_t i = 0; i < macs.size(); i++) {
+    hosts.emplace(to_key(macs.at(i)), i);
+  }
+}
+
+std::optional<size_t>
+Magic_packet_scanner::operator()(Packet_view const data) const {
+  for (auto sync = find_sync_stream(data, 0, level); sync < data.size();
+       sync = find_sync_stream(data, sync + 1, level)) {
+    auto const mac = magic_packet_mac(data, sync);
+    if (!mac.has_value()) {
+      continue;
+    }
+    auto const host = hosts.find(to_key(*mac));
+    if (host != std::end(hosts)) {
+      return host->second;
+    }
+  }
+  return std::nullopt;
+}
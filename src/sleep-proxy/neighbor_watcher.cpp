@@ -0,0 +1,79 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+
+#include "neighbor_watcher.h"
+#include "ethernet.h"
+#include "log.h"
+#include <algorithm>
+#include <linux/rtnetlink.h>
+
+Neighbor_watcher::Neighbor_watcher()
+    : netlink{RTMGRP_NEIGH}, poller{}, mutex{}, next_id{0}, watches{},
+      running{true}, thread{} {
+  poller.add(netlink.fd(), [this] { notify(netlink.receive_neighbors()); });
+  thread = std::thread(&Neighbor_watcher::thread_main, this);
+}
+
+Neighbor_watcher::~Neighbor_watcher() {
+  running = false;
+  poller.wake();
+  thread.join();
+}
+
+void Neighbor_watcher::notify(std::vector<Neighbor_info> const &neighbors) {
+  std::lock_guard<std::mutex> const lock{mutex};
+  for (auto const &neighbor : neighbors) {
+    for (auto const &[id, watch] : watches) {
+      if (watch.index != neighbor.index || watch.ip != neighbor.ip ||
+          std::ranges::equal(watch.own_mac.ether_addr_octet,
+                             neighbor.address.ether_addr_octet)) {
+        continue;
+      }
+      log(LOG_INFO, "kernel learned that %s is used by %s",
+          watch.ip.pure().c_str(), binary_to_mac(neighbor.address).c_str());
+      watch.claimed(Neighbor{.ip = neighbor.ip, .mac = neighbor.address});
+    }
+  }
+}
+
+void Neighbor_watcher::thread_main() {
+  try {
+    while (running) {
+      poller.poll();
+    }
+  } catch (std::exception const &e) {
+    log(LOG_ERR, "Neighbor_watcher stopped: %s", e.what());
+  }
+}
+
+uint64_t Neighbor_watcher::watch(std::string const &iface,
+                                 IP_address const &ip, Claimed claimed) {
+  // the socket of the thread only receives notifications
+  auto const link = Netlink_socket{}.get_link(iface);
+  std::lock_guard<std::mutex> const lock{mutex};
+  auto const id = next_id++;
+  watches.emplace(id, Watch{.index = link.index,
+                            .ip = ip.host(),
+                            .own_mac = link.address,
+                            .claimed = std::move(claimed)});
+  return id;
+}
+
+void Neighbor_watcher::unwatch(uint64_t const id) {
+  std::lock_guard<std::mutex> const lock{mutex};
+  watches.erase(id);
+}
@@ -0,0 +1,327 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "netlink.h"
+#include "container_utils.h"
+#include "ip.h"
+#include "log.h"
+#include <cerrno>
+#include <cstring>
+#include <linux/if_link.h>
+#include <linux/neighbour.h>
+#include <linux/netlink.h>
+#include <linux/rtnetlink.h>
+#include <span>
+#include <stdexcept>
+#include <sys/socket.h>
+
+namespace {
+template <typename T>
+void append(std::vector<uint8_t> &buffer, T const &value) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto const *const bytes = reinterpret_cast<uint8_t const *>(&value);
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+  buffer.insert(std::end(buffer), bytes, bytes + sizeof(T));
+}
+
+/** netlink messages and their attributes start 4 byte aligned */
+void pad(std::vector<uint8_t> &buffer) {
+  buffer.resize(NLMSG_ALIGN(buffer.size()));
+}
+
+void append_attribute(std::vector<uint8_t> &buffer, uint16_t const type,
+                      std::span<uint8_t const> const data) {
+  rtattr const attribute{
+      .rta_len = static_cast<unsigned short>(RTA_LENGTH(data.size())),
+      .rta_type = type};
+  append(buffer, attribute);
+  buffer.insert(std::end(buffer), std::begin(data), std::end(data));
+  pad(buffer);
+}
+
+void append_header(std::vector<uint8_t> &buffer, int const type,
+                   int const flags, uint32_t const sequence) {
+  append(buffer, nlmsghdr{.nlmsg_len = 0,
+                          .nlmsg_type = static_cast<uint16_t>(type),
+                          .nlmsg_flags = static_cast<uint16_t>(flags),
+                          .nlmsg_seq = sequence,
+                          .nlmsg_pid = 0});
+}
+
+/** writes the length of the message starting at start into its header */
+void finish_message(std::vector<uint8_t> &buffer, size_t const start) {
+  auto const length = static_cast<uint32_t>(buffer.size() - start);
+  std::memcpy(&buffer.at(start), &length, sizeof(length));
+}
+
+template <typename T>
+T read(std::span<uint8_t const> const data, size_t const offset) {
+  if (offset + sizeof(T) > data.size()) {
+    throw std::length_error("netlink message is too short");
+  }
+  T value{};
+  std::memcpy(&value, &data[offset], sizeof(T));
+  return value;
+}
+
+/** calls func with the header and the payload of each message in data */
+template <typename Func>
+void for_each_message(std::span<uint8_t const> const data, Func &&func) {
+  for (size_t offset = 0; offset + NLMSG_HDRLEN <= data.size();) {
+    auto const header = read<nlmsghdr>(data, offset);
+    if (header.nlmsg_len < NLMSG_HDRLEN ||
+        offset + header.nlmsg_len > data.size()) {
+      throw std::length_error("invalid netlink message length");
+    }
+    func(header, data.subspan(offset + NLMSG_HDRLEN,
+                              header.nlmsg_len - NLMSG_HDRLEN));
+    offset += NLMSG_ALIGN(header.nlmsg_len);
+  }
+}
+
+/**
+ * calls func with the type and the data of each attribute of payload, which
+ * start at offset
+ */
+template <typename Func>
+void for_each_attribute(std::span<uint8_t const> const payload, size_t offset,
+                        Func &&func) {
+  while (offset + sizeof(rtattr) <= payload.size()) {
+    auto const attribute = read<rtattr>(payload, offset);
+    if (attribute.rta_len < sizeof(rtattr) ||
+        offset + attribute.rta_len > payload.size()) {
+      throw std::length_error("invalid netlink attribute length");
+    }
+    func(attribute.rta_type,
+         payload.subspan(offset + RTA_LENGTH(0),
+                         attribute.rta_len - RTA_LENGTH(0)));
+    offset += RTA_ALIGN(attribute.rta_len);
+  }
+}
+
+/** like ip(8) give IPv4 loopback addresses host scope, the kernel demands it */
+uint8_t get_scope(IP_address const &ip) {
+  static auto const loopback_net = uint8_t{127};
+  return ip.family == AF_INET && ip.bytes().front() == loopback_net
+             ? RT_SCOPE_HOST
+             : RT_SCOPE_UNIVERSE;
+}
+
+std::string to_string(Action const action) {
+  return action == Action::add ? "RTM_NEWADDR" : "RTM_DELADDR";
+}
+} // namespace
+
+std::optional<Neighbor_info>
+parse_new_neighbor(std::span<uint8_t const> const payload) {
+  auto const neighbor = read<ndmsg>(payload, 0);
+  // entries being resolved or which failed to resolve have no valid address
+  if ((neighbor.ndm_state & (NUD_INCOMPLETE | NUD_FAILED)) != 0) {
+    return std::nullopt;
+  }
+  std::optional<IP_address> ip;
+  std::optional<ether_addr> address;
+  for_each_attribute(
+      payload, NLMSG_ALIGN(sizeof(ndmsg)),
+      [&](uint16_t const type, std::span<uint8_t const> const data) {
+        if (type == NDA_DST && neighbor.ndm_family == AF_INET &&
+            data.size() == sizeof(in_addr)) {
+          static auto const no_subnet = uint8_t{32};
+          ip = IP_address{.family = AF_INET,
+                          .address = {read<in_addr>(data, 0)},
+                          .subnet = no_subnet};
+        } else if (type == NDA_DST && neighbor.ndm_family == AF_INET6 &&
+                   data.size() == sizeof(in6_addr)) {
+          ip = get_ipv6_address(read<in6_addr>(data, 0));
+        } else if (type == NDA_LLADDR && data.size() == ETH_ALEN) {
+          address = read<ether_addr>(data, 0);
+        }
+      });
+  if (!ip.has_value() || !address.has_value()) {
+    return std::nullopt;
+  }
+  return Neighbor_info{
+      .index = neighbor.ndm_ifindex, .ip = *ip, .address = *address};
+}
+
+Netlink_socket::Netlink_socket(uint32_t const groups)
+    : Socket{AF_NETLINK, SOCK_RAW | SOCK_CLOEXEC, NETLINK_ROUTE}, sequence{1} {
+  if (groups == 0) {
+    return;
+  }
+  sockaddr_nl const local{
+      .nl_family = AF_NETLINK, .nl_pad = 0, .nl_pid = 0, .nl_groups = groups};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  if (bind(fd(), reinterpret_cast<sockaddr const *>(&local), sizeof(local)) ==
+      -1) {
+    throw std::runtime_error(std::string("bind() of netlink socket failed: ") +
+                             strerror(errno));
+  }
+}
+
+std::vector<Netlink_socket::Answer>
+Netlink_socket::transact(std::vector<uint8_t> const &messages,
+                         uint32_t const first_sequence, size_t const count) {
+  sockaddr_nl const kernel{
+      .nl_family = AF_NETLINK, .nl_pad = 0, .nl_pid = 0, .nl_groups = 0};
+  send_to(messages, 0, kernel);
+
+  std::vector<Answer> answers(count, Answer{.error = 0, .type = 0,
+                                            .payload = {}});
+  std::vector<bool> answered(count, false);
+  size_t missing = count;
+  // errors carry the request, leave enough space for several of them
+  static auto const buffer_size = size_t{1} << 16U;
+  std::vector<uint8_t> buffer(buffer_size);
+  while (missing > 0) {
+    auto const received = recv(fd(), buffer.data(), buffer.size(), 0);
+    if (received == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::runtime_error(std::string("recv() from netlink failed: ") +
+                               strerror(errno));
+    }
+    auto const data =
+        std::span<uint8_t const>{buffer}.first(static_cast<size_t>(received));
+    for_each_message(data, [&](nlmsghdr const &header,
+                               std::span<uint8_t const> const payload) {
+      // answers to requests of someone else or which were already answered
+      auto const index = size_t{header.nlmsg_seq - first_sequence};
+      if (header.nlmsg_seq < first_sequence || index >= count ||
+          answered.at(index)) {
+        return;
+      }
+      auto &answer = answers.at(index);
+      answer.type = header.nlmsg_type;
+      if (header.nlmsg_type == NLMSG_ERROR) {
+        answer.error = read<nlmsgerr>(payload, 0).error;
+      } else {
+        answer.payload.assign(std::begin(payload), std::end(payload));
+      }
+      answered.at(index) = true;
+      missing--;
+    });
+  }
+  return answers;
+}
+
+void Netlink_socket::change_addresses(Action const action, int const ifindex,
+                                      std::vector<IP_address> const &ips) {
+  if (ips.empty()) {
+    return;
+  }
+  int const flags = action == Action::add
+                        ? NLM_F_REQUEST | NLM_F_ACK | NLM_F_CREATE | NLM_F_EXCL
+                        : NLM_F_REQUEST | NLM_F_ACK;
+  auto const first_sequence = sequence;
+  std::vector<uint8_t> messages;
+  for (auto const &ip : ips) {
+    auto const start = messages.size();
+    append_header(messages, action == Action::add ? RTM_NEWADDR : RTM_DELADDR,
+                  flags, sequence++);
+    append(messages, ifaddrmsg{.ifa_family = static_cast<uint8_t>(ip.family),
+                               .ifa_prefixlen = ip.subnet,
+                               .ifa_flags = 0,
+                               .ifa_scope = get_scope(ip),
+                               .ifa_index = static_cast<uint32_t>(ifindex)});
+    append_attribute(messages, IFA_LOCAL, ip.bytes());
+    append_attribute(messages, IFA_ADDRESS, ip.bytes());
+    finish_message(messages, start);
+  }
+
+  auto const answers = transact(messages, first_sequence, ips.size());
+  std::vector<std::string> errors;
+  for (size_t i = 0; i < answers.size(); i++) {
+    if (answers.at(i).error != 0) {
+      errors.emplace_back(ips.at(i).with_subnet() + ": " +
+                          strerror(-answers.at(i).error));
+    }
+  }
+  if (!errors.empty()) {
+    throw std::runtime_error(to_string(action) + " failed for " +
+                             join(errors, identity<std::string>, ", "));
+  }
+}
+
+Link_info Netlink_socket::get_link(std::string const &iface) {
+  auto const first_sequence = sequence;
+  std::vector<uint8_t> message;
+  append_header(message, RTM_GETLINK, NLM_F_REQUEST, sequence++);
+  ifinfomsg info{};
+  info.ifi_family = AF_UNSPEC;
+  append(message, info);
+  // the name is sent with its terminating null
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  append_attribute(message, IFLA_IFNAME,
+                   {reinterpret_cast<uint8_t const *>(iface.c_str()),
+                    iface.size() + 1});
+  finish_message(message, 0);
+
+  auto const answer = transact(message, first_sequence, 1).at(0);
+  if (answer.error != 0 || answer.type != RTM_NEWLINK) {
+    throw std::runtime_error("RTM_GETLINK for " + iface +
+                             " failed: " + strerror(-answer.error));
+  }
+  std::span<uint8_t const> const payload{answer.payload};
+  auto const link = read<ifinfomsg>(payload, 0);
+  Link_info result{.index = link.ifi_index, .flags = link.ifi_flags,
+                   .address = {}};
+  for_each_attribute(
+      payload, NLMSG_ALIGN(sizeof(ifinfomsg)),
+      [&](uint16_t const type, std::span<uint8_t const> const data) {
+        if (type == IFLA_ADDRESS && data.size() == ETH_ALEN) {
+          result.address = read<ether_addr>(data, 0);
+        }
+      });
+  return result;
+}
+
+std::vector<Neighbor_info> Netlink_socket::receive_neighbors() {
+  std::vector<Neighbor_info> neighbors;
+  static auto const buffer_size = size_t{1} << 16U;
+  std::vector<uint8_t> buffer(buffer_size);
+  for (;;) {
+    auto const received =
+        recv(fd(), buffer.data(), buffer.size(), MSG_DONTWAIT);
+    if (received == -1) {
+      if (errno == EINTR) {
+        continue;
+      }
+      // the kernel drops notifications if they are not read fast enough
+      if (errno == ENOBUFS) {
+        log_string(LOG_WARNING, "missed netlink notifications");
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        throw std::runtime_error(
+            std::string("recv() from netlink failed: ") + strerror(errno));
+      }
+      return neighbors;
+    }
+    for_each_message(
+        std::span<uint8_t const>{buffer}.first(static_cast<size_t>(received)),
+        [&](nlmsghdr const &header, std::span<uint8_t const> const payload) {
+          if (header.nlmsg_type != RTM_NEWNEIGH) {
+            return;
+          }
+          auto const neighbor = parse_new_neighbor(payload);
+          if (neighbor.has_value()) {
+            neighbors.push_back(*neighbor);
+          }
+        });
+  }
+}
@@ -17,53 +17,86 @@
 #include "packet_parser.h"
 #include "log.h"
 #include <iterator>
-#include <memory>
 
 template <typename T>
-void print_if_not_nullptr(std::ostream &out, std::unique_ptr<T> const &ptr) {
-  if (ptr != nullptr) {
-    out << *ptr;
+void print_if_has_value(std::ostream &out, std::optional<T> const &opt) {
+  if (opt.has_value()) {
+    out << *opt;
   }
 }
 
 std::ostream &operator<<(std::ostream &out, const basic_headers &headers) {
-  print_if_not_nullptr(out, std::get<0>(headers));
+  print_if_has_value(out, std::get<0>(headers));
   out << '\n';
-  print_if_not_nullptr(out, std::get<1>(headers));
+  print_if_has_value(out, std::get<1>(headers));
   return out;
 }
 
-basic_headers get_headers(const int type, const std::vector<u_char> &packet) {
+basic_headers get_headers(const int type, Packet_view const packet) {
   auto data = std::begin(packet);
   auto end = std::end(packet);
 
   // link layer header
-  std::unique_ptr<Link_layer> ll = parse_link_layer(type, data, end);
-  if (ll == nullptr) {
+  std::optional<Link_layer> const ll = parse_link_layer(type, data, end);
+  if (!ll.has_value()) {
     log(LOG_ERR, "unsupported link layer protocol: %i", type);
-    return std::make_tuple(std::unique_ptr<Link_layer>(nullptr),
-                           std::unique_ptr<ip>(nullptr));
+    return {};
   }
-  std::advance(data, ll->header_length());
+  return get_headers(*ll, packet);
+}
+
+basic_headers get_headers(Link_layer const &ll, Packet_view const packet) {
+  auto data = std::begin(packet);
+  auto end = std::end(packet);
+  std::advance(data, ll.header_length());
 
   // possible VLAN header, skip it
-  uint16_t payload_type = ll->payload_protocol();
+  uint16_t payload_type = ll.payload_protocol();
   if (payload_type == ETHERTYPE_VLAN) {
-    std::unique_ptr<Link_layer> vlan_header =
-        parse_link_layer(payload_type, data, end);
+    std::optional<Link_layer> const vlan_header = parse_VLAN_Header(data, end);
     payload_type = vlan_header->payload_protocol();
     std::advance(data, vlan_header->header_length());
   }
 
   // IP header
-  std::unique_ptr<ip> ipp = parse_ip(payload_type, data, end);
-  if (ipp == nullptr) {
-    log(LOG_ERR, "unsupported link layer payload: %u", payload_type);
-    return std::make_tuple(std::move(ll), std::unique_ptr<ip>(nullptr));
+  std::optional<ip> const ipp = parse_ip(payload_type, data, end);
+  if (!ipp.has_value()) {
+    // ARP is captured to see who claims an address, it is no error
+    if (payload_type != ETHERTYPE_ARP) {
+      log(LOG_ERR, "unsupported link layer payload: %u", payload_type);
+    }
+    return {ll, std::nullopt};
   }
-  std::advance(data, ipp->header_length());
 
-  return std::make_tuple(std::move(ll), std::move(ipp));
+  return {ll, ipp};
+}
+
+std::optional<uint16_t>
+get_destination_port(const basic_headers &headers, Packet_view const packet) {
+  auto const &ll = std::get<0>(headers);
+  auto const &ipp = std::get<1>(headers);
+  if (!ll.has_value() || !ipp.has_value() ||
+      (ipp->payload_protocol() != ip::TCP &&
+       ipp->payload_protocol() != ip::UDP)) {
+    return std::nullopt;
+  }
+  auto offset = ll->header_length() + ipp->header_length();
+  if (ll->payload_protocol() == ETHERTYPE_VLAN) {
+    offset += Link_layer::vlan_header_size;
+  }
+  // source port comes first, destination port follows
+  static auto const destination_port_offset = size_t{2};
+  offset += destination_port_offset;
+  if (packet.size() < offset + sizeof(uint16_t)) {
+    return std::nullopt;
+  }
+  static auto const byte_size = uint8_t{8};
+  return static_cast<uint16_t>(packet[offset] << byte_size |
+                               packet[offset + 1]);
+}
+
+Packet_view to_packet_view(const pcap_pkthdr &header, const u_char *packet) {
+  return {packet, header.len};
 }
 
 Catch_incoming_connection::Catch_incoming_connection(const int link_layer_typee)
@@ -76,10 +109,14 @@ void Catch_incoming_connection::operator()(const pcap_pkthdr *header,
     return;
   }
   try {
-    const auto *end_iter = packet;
-    std::advance(end_iter, header->len);
-    data = std::vector<uint8_t>(packet, end_iter);
-    headers = get_headers(link_layer_type, data);
+    auto const view = to_packet_view(*header, packet);
+    headers = get_headers(link_layer_type, view);
+    if (std::get<1>(headers).has_value()) {
+      // this is the packet to replay, keep it
+      data.assign(std::begin(view), std::end(view));
+    } else {
+      data.clear();
+    }
   } catch (std::exception const &e) {
     log_string(LOG_ERR,
                std::string("Catch_incoming_connection caught an exception: ") +
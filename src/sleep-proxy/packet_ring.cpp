@@ -0,0 +1,359 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "packet_ring.h"
+
+#include "log.h"
+#include "pcap_wrapper.h"
+#include "to_string.h"
+#include <arpa/inet.h>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <linux/filter.h>
+#include <linux/if_ether.h>
+#include <linux/if_packet.h>
+#include <memory>
+#include <mutex>
+#include <net/if_arp.h>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace {
+/** size of the linux cooked capture header synthesized in front of packets */
+auto const sll_header_size = uint32_t{16};
+
+/** frame size of the ring. TPACKET_V3 packs packets, the kernel checks it */
+auto const frame_size = uint32_t{TPACKET_ALIGNMENT << 7U};
+
+/** TPACKET_ALIGN() without the sign conversion warnings */
+constexpr size_t tpacket_align(size_t const size) {
+  return (size + TPACKET_ALIGNMENT - 1U) / TPACKET_ALIGNMENT *
+         TPACKET_ALIGNMENT;
+}
+
+int select_datalink(std::string const &iface) {
+  if (iface == "any") {
+    return DLT_LINUX_SLL;
+  }
+  Socket const sock(AF_INET, SOCK_DGRAM);
+  switch (sock.get_hwtype(iface)) {
+  case ARPHRD_ETHER:
+  case ARPHRD_LOOPBACK:
+    return DLT_EN10MB;
+  default:
+    return DLT_LINUX_SLL;
+  }
+}
+
+int get_socket_type(int const datalink) {
+  return datalink == DLT_EN10MB ? SOCK_RAW : SOCK_DGRAM;
+}
+
+/**
+ * sockets delivering linux cooked captures are SOCK_DGRAM sockets, which run
+ * the kernel filter on the network header
+ */
+int get_kernel_datalink(int const datalink) {
+  return datalink == DLT_EN10MB ? DLT_EN10MB : DLT_RAW;
+}
+
+std::optional<bpf_program> compile(int const datalink, uint32_t const snaplen,
+                                   std::string const &filter) {
+  std::unique_ptr<pcap_t, void (*)(pcap_t *)> const dead{
+      pcap_open_dead(datalink, static_cast<int>(snaplen)), pcap_close};
+  if (dead == nullptr) {
+    throw std::runtime_error("pcap_open_dead() failed");
+  }
+  std::lock_guard<std::mutex> const lock(get_pcap_compile_mutex());
+  bpf_program bpf{.bf_len = 0, .bf_insns = nullptr};
+  if (pcap_compile(dead.get(), &bpf, filter.c_str(), 0,
+                   PCAP_NETMASK_UNKNOWN) == -1) {
+    return std::nullopt;
+  }
+  return bpf;
+}
+
+template <typename Optval>
+int set_sock_opt_nothrow(int const fd, int const level, int const optname,
+                         Optval const &optval) {
+  return setsockopt(fd, level, optname, &optval, sizeof(Optval));
+}
+
+sock_fprog to_sock_fprog(bpf_program const &bpf) {
+  // bpf_insn and sock_filter share the same layout
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  return {.len = static_cast<unsigned short>(bpf.bf_len),
+          .filter = reinterpret_cast<sock_filter *>(bpf.bf_insns)};
+}
+
+/** a filter not accepting any packet */
+void attach_drop_all(int const fd) {
+  std::array<sock_filter, 1> drop{{{.code = BPF_RET | BPF_K,
+                                    .jt = 0,
+                                    .jf = 0,
+                                    .k = 0}}};
+  sock_fprog const prog{.len = drop.size(), .filter = drop.data()};
+  if (set_sock_opt_nothrow(fd, SOL_SOCKET, SO_ATTACH_FILTER, prog) == -1) {
+    throw std::runtime_error(std::string("can't attach filter: ") +
+                             strerror(errno));
+  }
+}
+
+/** writes a linux cooked capture header in front of the packet at data */
+void write_sll_header(uint8_t *const data, sockaddr_ll const &sll) {
+  auto *iter = data;
+  auto const write16 = [&iter](uint16_t const value) {
+    *iter++ = static_cast<uint8_t>(value >> 8U);
+    *iter++ = static_cast<uint8_t>(value);
+  };
+  write16(sll.sll_pkttype);
+  write16(sll.sll_hatype);
+  write16(sll.sll_halen);
+  std::ranges::copy(sll.sll_addr, iter);
+  std::advance(iter, sizeof(sll.sll_addr));
+  // sll_protocol already is in network byte order
+  std::memcpy(iter, &sll.sll_protocol, sizeof(sll.sll_protocol));
+}
+} // namespace
+
+Packet_ring::Packet_ring(std::string const &iface, uint32_t const snaplenn,
+                         Ring_config const &configg)
+    : Socket(AF_PACKET, get_socket_type(select_datalink(iface)),
+             htons(ETH_P_ALL)),
+      datalink{select_datalink(iface)}, snaplen{snaplenn}, config{configg},
+      ring{nullptr}, ring_size{0}, current_block{0}, block_packets_read{0},
+      wakeup{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)}, break_requested{false},
+      accept_all_pending{true}, userspace_filter{} {
+  if (wakeup.fd == -1) {
+    throw std::runtime_error(std::string("eventfd() failed: ") +
+                             strerror(errno));
+  }
+  auto const page_size = static_cast<uint32_t>(sysconf(_SC_PAGESIZE));
+  if (config.block_size == 0 || config.block_size % page_size != 0 ||
+      config.block_size % frame_size != 0 || config.block_count == 0) {
+    throw std::runtime_error("ring block size " +
+                             to_string(config.block_size) +
+                             " is no multiple of the page size " +
+                             to_string(page_size));
+  }
+  // nothing gets into the ring until set_filter() or loop() is called
+  attach_drop_all(fd());
+  set_sock_opt(SOL_PACKET, PACKET_VERSION, int{TPACKET_V3});
+  if (datalink != DLT_EN10MB) {
+    // room for the linux cooked capture header
+    set_sock_opt(SOL_PACKET, PACKET_RESERVE, sll_header_size);
+  }
+  tpacket_req3 const req{
+      .tp_block_size = config.block_size,
+      .tp_block_nr = config.block_count,
+      .tp_frame_size = frame_size,
+      .tp_frame_nr = config.block_size / frame_size * config.block_count,
+      .tp_retire_blk_tov = config.block_timeout,
+      .tp_sizeof_priv = 0,
+      .tp_feature_req_word = 0};
+  set_sock_opt(SOL_PACKET, PACKET_RX_RING, req);
+  ring_size = size_t{config.block_size} * config.block_count;
+  void *const mem = mmap(nullptr, ring_size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_LOCKED, fd(), 0);
+  if (mem == MAP_FAILED) {
+    throw std::runtime_error(std::string("mmap() of packet ring failed: ") +
+                             strerror(errno));
+  }
+  ring = static_cast<uint8_t *>(mem);
+  sockaddr_ll const addr{
+      .sll_family = AF_PACKET,
+      .sll_protocol = htons(ETH_P_ALL),
+      .sll_ifindex = iface == "any" ? 0 : get_ifindex(iface),
+      .sll_hatype = 0,
+      .sll_pkttype = 0,
+      .sll_halen = 0,
+      .sll_addr = {0}};
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  if (bind(fd(), reinterpret_cast<sockaddr const *>(&addr), sizeof(addr)) ==
+      -1) {
+    munmap(ring, ring_size);
+    throw std::runtime_error("can't bind packet socket to " + iface + ": " +
+                             strerror(errno));
+  }
+  log(LOG_INFO, "packet ring on %s with %u blocks of %u bytes", iface.c_str(),
+      config.block_count, config.block_size);
+}
+
+Packet_ring::~Packet_ring() {
+  free_userspace_filter();
+  if (ring != nullptr) {
+    munmap(ring, ring_size);
+  }
+}
+
+void Packet_ring::free_userspace_filter() {
+  if (userspace_filter.has_value()) {
+    pcap_freecode(&*userspace_filter);
+    userspace_filter.reset();
+  }
+}
+
+int Packet_ring::get_datalink() const { return datalink; }
+
+void Packet_ring::set_filter(std::string const &filter) {
+  free_userspace_filter();
+  auto kernel_bpf = compile(get_kernel_datalink(datalink), snaplen, filter);
+  if (kernel_bpf.has_value()) {
+    auto const prog = to_sock_fprog(*kernel_bpf);
+    int const ret = set_sock_opt_nothrow(fd(), SOL_SOCKET, SO_ATTACH_FILTER,
+                                         prog);
+    pcap_freecode(&*kernel_bpf);
+    if (ret == 0) {
+      accept_all_pending = false;
+      return;
+    }
+    log(LOG_INFO, "kernel refused filter, filtering in userspace: %s",
+        strerror(errno));
+  }
+  // e.g. "ether proto" cannot be checked on the network header
+  userspace_filter = compile(datalink, snaplen, filter);
+  if (!userspace_filter.has_value()) {
+    throw std::runtime_error("Can't compile bpf filter " + filter);
+  }
+  accept_all_pending = true;
+}
+
+bool Packet_ring::read_block(uint8_t *const block, int &count,
+                             pcap_handler const callback, u_char *const user) {
+  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+  auto const &desc = *reinterpret_cast<tpacket_block_desc *>(block);
+  auto const num_pkts = desc.hdr.bh1.num_pkts;
+  auto *packet = std::next(block, desc.hdr.bh1.offset_to_first_pkt);
+  for (uint32_t i = 0; i < num_pkts; i++) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto const &tp = *reinterpret_cast<tpacket3_hdr *>(packet);
+    if (i >= block_packets_read) {
+      block_packets_read = i + 1;
+      auto *data = std::next(packet, tp.tp_mac);
+      uint32_t caplen = tp.tp_snaplen;
+      uint32_t len = tp.tp_len;
+      if (datalink != DLT_EN10MB) {
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+        auto const &sll = *reinterpret_cast<sockaddr_ll *>(
+            std::next(packet, tpacket_align(sizeof(tpacket3_hdr))));
+        data = std::prev(data, sll_header_size);
+        write_sll_header(data, sll);
+        caplen += sll_header_size;
+        len += sll_header_size;
+      }
+      static auto const nsec_per_usec = uint32_t{1000};
+      pcap_pkthdr const header{
+          .ts = {.tv_sec = tp.tp_sec, .tv_usec = tp.tp_nsec / nsec_per_usec},
+          .caplen = caplen,
+          .len = len};
+      if (!userspace_filter.has_value() ||
+          pcap_offline_filter(&*userspace_filter, &header, data) != 0) {
+        callback(user, &header, data);
+        if (count > 0 && --count == 0) {
+          return true;
+        }
+      }
+      if (break_requested.load()) {
+        return true;
+      }
+    }
+    packet = std::next(packet, tp.tp_next_offset);
+  }
+  return false;
+}
+
+bool Packet_ring::loop(int count, pcap_handler const callback,
+                       u_char *const user) {
+  if (accept_all_pending) {
+    // no filter set or filtered in userspace
+    int const unused = 0;
+    if (set_sock_opt_nothrow(fd(), SOL_SOCKET, SO_DETACH_FILTER, unused) ==
+            -1 &&
+        errno != ENOENT) {
+      throw std::runtime_error(std::string("can't detach filter: ") +
+                               strerror(errno));
+    }
+    accept_all_pending = false;
+  }
+  int const wanted = count;
+  while (!break_requested.exchange(false)) {
+    auto *const block =
+        std::next(ring, ptrdiff_t{current_block} * config.block_size);
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
+    auto &desc = *reinterpret_cast<tpacket_block_desc *>(block);
+    std::atomic_ref<uint32_t> status{desc.hdr.bh1.block_status};
+    if ((status.load(std::memory_order_acquire) & TP_STATUS_USER) == 0) {
+      std::array<pollfd, 2> fds{
+          {{.fd = fd(), .events = POLLIN | POLLERR, .revents = 0},
+           {.fd = wakeup.fd, .events = POLLIN, .revents = 0}}};
+      if (poll(fds.data(), fds.size(), -1) == -1) {
+        if (errno == EINTR) {
+          continue;
+        }
+        throw std::runtime_error(std::string("poll() failed: ") +
+                                 strerror(errno));
+      }
+      if ((fds.at(1).revents & POLLIN) != 0) {
+        uint64_t value = 0;
+        static_cast<void>(read(wakeup.fd, &value, sizeof(value)));
+      }
+      if ((fds.at(0).revents & POLLERR) != 0) {
+        int error = 0;
+        socklen_t error_len = sizeof(error);
+        getsockopt(fd(), SOL_SOCKET, SO_ERROR, &error, &error_len);
+        throw std::runtime_error(std::string("error on packet socket: ") +
+                                 strerror(error));
+      }
+      continue;
+    }
+    bool const stop = read_block(block, count, callback, user);
+    if (block_packets_read >= desc.hdr.bh1.num_pkts) {
+      // hand the block back to the kernel
+      block_packets_read = 0;
+      status.store(TP_STATUS_KERNEL, std::memory_order_release);
+      current_block = (current_block + 1) % config.block_count;
+    }
+    if (stop) {
+      break_requested = false;
+      return wanted > 0 && count == 0;
+    }
+  }
+  return false;
+}
+
+void Packet_ring::break_loop() {
+  break_requested = true;
+  uint64_t const value = 1;
+  static_cast<void>(write(wakeup.fd, &value, sizeof(value)));
+}
+
+int Packet_ring::inject(std::vector<uint8_t> const &data) {
+  if (datalink != DLT_EN10MB) {
+    throw std::runtime_error(
+        "can't inject packets with a packet ring of a linux cooked capture");
+  }
+  auto const bytes = send(fd(), data.data(), data.size(), 0);
+  if (bytes == -1) {
+    throw std::runtime_error(std::string("send() failed: ") +
+                             strerror(errno));
+  }
+  return static_cast<int>(bytes);
+}
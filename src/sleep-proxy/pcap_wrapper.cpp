@@ -19,44 +19,15 @@
 #include "log.h"
 #include "to_string.h"
 #include <mutex>
-#include <pthread.h>
 #include <stdexcept>
 
-namespace {
-/**
- * provide a way to pass std::function objects as an callback to the C++
- * interface. this function is called inside the C library and calls the C++
- * functor
- */
-void callback_wrapper(u_char *args, const struct pcap_pkthdr *header,
-                      const u_char *packet) {
-  // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-  auto *const cb = reinterpret_cast<Pcap_wrapper::Callback_t *>(args);
-  (*cb)(header, packet);
-}
-
-std::function<void(pcap_t *const, int const, Pcap_wrapper::Callback_t)>
-create_loop(int &ret_val) {
-  auto loop_f = [&ret_val](pcap_t *const pcc, const int count,
-                           Pcap_wrapper::Callback_t cb) {
-    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast)
-    auto *const args = reinterpret_cast<u_char *>(&cb);
-    ret_val = pcap_loop(pcc, count, callback_wrapper, args);
-  };
-  return loop_f;
-}
-} // namespace
-
 /** provides a bpf_programm instance in an exception safe way */
 struct BPF {
   bpf_program bpf;
   BPF(std::unique_ptr<pcap_t, void (*)(pcap_t *)> &pc,
       const std::string &filter)
       : bpf{.bf_len = 0, .bf_insns = nullptr} {
-    // pcap_compile is not thread safe
-    // see http://seclists.org/tcpdump/2012/q2/22
-    static std::mutex pcap_compile_mutex;
-    std::lock_guard<std::mutex> const lock(pcap_compile_mutex);
+    std::lock_guard<std::mutex> const lock(get_pcap_compile_mutex());
     if (pcap_compile(pc.get(), &bpf, filter.c_str(), 0, PCAP_NETMASK_UNKNOWN) ==
         -1) {
       throw std::runtime_error("Can't compile bpf filter " + filter);
@@ -69,19 +40,42 @@ struct BPF {
   BPF &operator=(BPF &&) = delete;
 };
 
+std::mutex &get_pcap_compile_mutex() {
+  static std::mutex pcap_compile_mutex;
+  return pcap_compile_mutex;
+}
+
 Pcap_wrapper::Pcap_wrapper()
-    : pc(nullptr, pcap_close), loop_thread{},
-      loop_end_reson_mutex{std::make_unique<std::mutex>()} {}
+    : pc(nullptr, pcap_close), ring{}, poller{}, selectable_fd{-1},
+      loop_end_reason{std::make_unique<std::atomic<Loop_end_reason>>(
+          Loop_end_reason::unset)} {}
 
 Pcap_wrapper::Loop_end_reason Pcap_wrapper::get_end_reason() const {
-  std::lock_guard<std::mutex> const lock{*loop_end_reson_mutex};
-  return loop_end_reason;
+  return *loop_end_reason;
 }
 
 Pcap_wrapper::Pcap_wrapper(const std::string &iface, const int snaplen,
                            const bool promisc, const int timeout)
-    : pc(pcap_create(iface.c_str(), errbuf.data()), pcap_close), loop_thread{},
-      loop_end_reson_mutex{std::make_unique<std::mutex>()} {
+    : Pcap_wrapper() {
+  open(iface, snaplen, promisc, timeout);
+}
+
+Pcap_wrapper::Pcap_wrapper(const std::string &iface,
+                           const Ring_config &ring_config, const int snaplen)
+    : Pcap_wrapper() {
+  try {
+    ring = std::make_unique<Packet_ring>(iface, static_cast<uint32_t>(snaplen),
+                                         ring_config);
+  } catch (std::exception const &e) {
+    log(LOG_WARNING, "can't set up packet ring on %s, using libpcap: %s",
+        iface.c_str(), e.what());
+    open(iface, snaplen, false, default_timeout);
+  }
+}
+
+void Pcap_wrapper::open(const std::string &iface, const int snaplen,
+                        const bool promisc, const int timeout) {
+  pc.reset(pcap_create(iface.c_str(), errbuf.data()));
   if (pc == nullptr) {
     throw std::runtime_error(errbuf.data());
   }
@@ -102,12 +96,27 @@ Pcap_wrapper::Pcap_wrapper(const std::string &iface, const int snaplen,
     throw std::runtime_error("interface: " + iface +
                              " can't activate selected interface: " + iface);
   }
+  // loop() waits with epoll and reads whatever is there
+  if (pcap_setnonblock(pc.get(), 1, errbuf.data()) == -1) {
+    throw std::runtime_error("interface: " + iface +
+                             " can't switch to non blocking mode: " +
+                             errbuf.data());
+  }
+  selectable_fd = pcap_get_selectable_fd(pc.get());
+  if (selectable_fd == -1) {
+    throw std::runtime_error("interface: " + iface +
+                             " has no file descriptor to wait on");
+  }
+  poller = std::make_unique<Poller>();
   log_string(LOG_INFO, "datalink " + get_verbose_datalink());
 }
 
 Pcap_wrapper::~Pcap_wrapper() = default;
 
 int Pcap_wrapper::get_datalink() const {
+  if (ring != nullptr) {
+    return ring->get_datalink();
+  }
   int datalink = pcap_datalink(pc.get());
   if (datalink == PCAP_ERROR_NOT_ACTIVATED) {
     throw std::runtime_error("can't get datalink type");
@@ -120,6 +129,8 @@ std::string Pcap_wrapper::get_verbose_datalink() const {
   switch (datalink) {
   case DLT_LINUX_SLL:
     return "Linux cooked socket";
+  case DLT_LINUX_SLL2:
+    return "Linux cooked socket v2";
   case DLT_EN10MB:
     return "ethernet";
   default:
@@ -128,6 +139,10 @@ std::string Pcap_wrapper::get_verbose_datalink() const {
 }
 
 void Pcap_wrapper::set_filter(const std::string &filter) {
+  if (ring != nullptr) {
+    ring->set_filter(filter);
+    return;
+  }
   BPF bpf(pc, filter);
   if (pcap_setfilter(pc.get(), &bpf.bpf) == -1) {
     throw std::runtime_error("Couldn't install filter " + filter + ": " +
@@ -137,41 +152,71 @@ void Pcap_wrapper::set_filter(const std::string &filter) {
 
 Pcap_wrapper::Loop_end_reason Pcap_wrapper::loop(const int count,
                                                  Callback_t cb) {
-  int ret_val = 1;
-  auto loop_f = create_loop(ret_val);
-
-  loop_thread = std::thread{loop_f, pc.get(), count, std::move(cb)};
-  loop_thread.join();
-
-  std::lock_guard<std::mutex> const lock{*loop_end_reson_mutex};
-  switch (ret_val) {
-  case 0:
-    loop_end_reason = Loop_end_reason::packets_captured;
-    break;
-  case PCAP_ERROR:
-    loop_end_reason = Loop_end_reason::error;
-    throw std::runtime_error(std::string("error while captching data: ") +
-                             pcap_geterr(pc.get()));
-  default:
-    break;
+  return loop<Callback_t &>(count, cb);
+}
+
+Pcap_wrapper::Loop_end_reason
+Pcap_wrapper::run_loop(const int count, pcap_handler const callback,
+                       u_char *const user) {
+  if (ring != nullptr) {
+    bool captured = false;
+    try {
+      captured = ring->loop(count, callback, user);
+    } catch (std::exception const &) {
+      *loop_end_reason = Loop_end_reason::error;
+      throw;
+    }
+    if (captured) {
+      *loop_end_reason = Loop_end_reason::packets_captured;
+    }
+    return *loop_end_reason;
+  }
+
+  int remaining = count;
+  bool captured = false;
+  auto const dispatch = [&] {
+    // like pcap_loop() a count of zero or less captures until break_loop()
+    int const ret = pcap_dispatch(pc.get(), remaining > 0 ? remaining : -1,
+                                  callback, user);
+    if (ret == PCAP_ERROR) {
+      *loop_end_reason = Loop_end_reason::error;
+      throw std::runtime_error(std::string("error while captching data: ") +
+                               pcap_geterr(pc.get()));
+    }
+    if (remaining > 0 && ret > 0) {
+      remaining -= ret;
+      captured = remaining <= 0;
+    }
+  };
+  poller->add(selectable_fd, dispatch);
+  try {
+    while (!captured && poller->poll()) {
+    }
+  } catch (std::exception const &) {
+    poller->remove(selectable_fd);
+    throw;
+  }
+  poller->remove(selectable_fd);
+  if (captured) {
+    *loop_end_reason = Loop_end_reason::packets_captured;
   }
-  return loop_end_reason;
+  return *loop_end_reason;
 }
 
 void Pcap_wrapper::break_loop(const Loop_end_reason &ler) {
-  {
-    std::lock_guard<std::mutex> const lock{*loop_end_reson_mutex};
-    loop_end_reason = ler;
+  *loop_end_reason = ler;
+  if (ring != nullptr) {
+    ring->break_loop();
   }
-  if (pc != nullptr) {
-    pcap_breakloop(pc.get());
-  }
-  if (loop_thread.joinable()) {
-    pthread_cancel(loop_thread.native_handle());
+  if (poller != nullptr) {
+    poller->wake();
   }
 }
 
 int Pcap_wrapper::inject(const std::vector<uint8_t> &data) {
+  if (ring != nullptr) {
+    return ring->inject(data);
+  }
   int bytes = pcap_inject(pc.get(), data.data(), data.size());
   if (bytes == -1) {
     throw std::runtime_error(std::string("pcap_inject() failed: ") +
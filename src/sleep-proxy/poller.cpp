@@ -0,0 +1,96 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "poller.h"
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+namespace {
+void control(int const epoll, int const operation, int const fd) {
+  epoll_event event{.events = EPOLLIN, .data = {.fd = fd}};
+  if (epoll_ctl(epoll, operation, fd, &event) == -1) {
+    throw std::runtime_error(std::string("epoll_ctl() failed: ") +
+                             strerror(errno));
+  }
+}
+} // namespace
+
+Poller::Poller()
+    : epoll{epoll_create1(EPOLL_CLOEXEC)},
+      wakeup{eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)}, woken{false},
+      handlers{} {
+  control(epoll, EPOLL_CTL_ADD, wakeup);
+}
+
+Poller::~Poller() = default;
+
+void Poller::add(int const fd, Handler handler) {
+  control(epoll, EPOLL_CTL_ADD, fd);
+  handlers.insert_or_assign(fd, std::move(handler));
+}
+
+void Poller::remove(int const fd) {
+  handlers.erase(fd);
+  control(epoll, EPOLL_CTL_DEL, fd);
+}
+
+bool Poller::poll(int const timeout) {
+  if (woken.exchange(false)) {
+    return false;
+  }
+  static auto const max_events = size_t{16};
+  std::array<epoll_event, max_events> events{};
+  int const ready = epoll_wait(epoll, events.data(),
+                               static_cast<int>(events.size()), timeout);
+  if (ready == -1 && errno != EINTR) {
+    throw std::runtime_error(std::string("epoll_wait() failed: ") +
+                             strerror(errno));
+  }
+  if (woken.exchange(false)) {
+    uint64_t value = 0;
+    static_cast<void>(read(wakeup, &value, sizeof(value)));
+    return false;
+  }
+  for (int i = 0; i < ready; i++) {
+    auto const fd = events.at(static_cast<size_t>(i)).data.fd;
+    if (fd == wakeup) {
+      // a wake() consumed by a previous poll()
+      uint64_t value = 0;
+      static_cast<void>(read(wakeup, &value, sizeof(value)));
+      continue;
+    }
+    // a handler might have removed another one
+    auto const handler = handlers.find(fd);
+    if (handler != std::end(handlers)) {
+      handler->second();
+    }
+  }
+  return true;
+}
+
+void Poller::wake() {
+  woken = true;
+  uint64_t const value = 1;
+  static_cast<void>(write(wakeup, &value, sizeof(value)));
+}
@@ -18,10 +18,14 @@
 #include "container_utils.h"
 #include "int_utils.h"
 #include "log.h"
+#include "netlink.h"
 #include "spawn_process.h"
 #include "to_string.h"
 #include <arpa/inet.h>
 #include <cerrno>
+#include <cstring>
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace {
 /**
@@ -45,6 +49,78 @@ std::string get_icmp_version(const IP_address &ip) {
   return ip.family == AF_INET ? "icmp" : "icmpv6";
 }
 
+/** file containing content, to be used as stdin of a child process */
+File_descriptor get_input_file(std::string const &content) {
+  File_descriptor file{memfd_create("ruleset", MFD_CLOEXEC)};
+  if (file.fd == -1) {
+    throw std::runtime_error(std::string("memfd_create() failed: ") +
+                             strerror(errno));
+  }
+  for (size_t written = 0; written < content.size();) {
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+    auto const rc = write(file, content.data() + written,
+                          content.size() - written);
+    if (rc == -1) {
+      throw std::runtime_error(std::string("write() failed: ") +
+                               strerror(errno));
+    }
+    written += static_cast<size_t>(rc);
+  }
+  if (lseek(file, 0, SEEK_SET) == -1) {
+    throw std::runtime_error(std::string("lseek() failed: ") +
+                             strerror(errno));
+  }
+  return file;
+}
+
+/** runs cmd, which reads ruleset from stdin */
+void apply_ruleset(std::vector<std::string> const &cmd,
+                   std::string const &ruleset) {
+  log_string(LOG_INFO, join(cmd, identity<std::string>, " ") + "\n" + ruleset);
+  if (spawn(cmd, get_input_file(ruleset)) != 0) {
+    throw std::runtime_error("command failed: " + cmd.at(0));
+  }
+}
+
+/** changes the rules of IP version family as given in ruleset atomically */
+void restore(int const family, std::string const &ruleset) {
+  apply_ruleset({family == AF_INET ? "iptables-restore" : "ip6tables-restore",
+                 "--noflush", "--wait"},
+                ruleset);
+}
+
+std::string const nft_table = "inet sleep_proxy";
+
+/** name of the set named name holding addresses of the version of ip */
+std::string nft_set(std::string const &name, IP_address const &ip) {
+  return name + (ip.family == AF_INET ? "4" : "6");
+}
+
+/** set and element of the set the rule is put into */
+std::pair<std::string, std::string> nft_element(Drop_port const &rule) {
+  return {nft_set("drop_syn", rule.ip),
+          rule.ip.pure() + " . " + to_string(rule.port)};
+}
+
+std::pair<std::string, std::string> nft_element(Reject_tp const &rule) {
+  auto const name =
+      rule.tcp_udp == Reject_tp::TP::TCP ? "reject_tcp" : "reject_udp";
+  return {nft_set(name, rule.ip), rule.ip.pure()};
+}
+
+std::pair<std::string, std::string> nft_element(Block_icmp const &rule) {
+  return {nft_set("drop_unreachable", rule.ip), rule.ip.pure()};
+}
+
+std::pair<std::string, std::string>
+nft_element(Block_ipv6_neighbor_solicitation const &rule) {
+  if (rule.ip.family != AF_INET6) {
+    throw std::runtime_error(
+        "cannot block neighbor solicitation for an ipv4 address");
+  }
+  return {"drop_solicitation", rule.ip.pure()};
+}
+
 std::string ipv6_to_u32_rule(IP_address const &ip) {
   if (ip.family != AF_INET6) {
     throw std::runtime_error(
@@ -112,42 +188,198 @@ std::string Temp_ip::operator()(const Action action) const {
          " dev " + iface;
 }
 
-std::string Drop_port::operator()(const Action action) const {
-  const std::string saction{iptables_action(action)};
-  const std::string iptcmd = get_iptables_cmd(ip);
-  const std::string pip = ip.pure();
-  return iptcmd + " -w -" + saction + " INPUT -d " + pip +
+std::string Temp_ips::operator()(const Action action) const {
+  auto const saction =
+      action == Action::add ? std::string{"adding"} : std::string{"removing"};
+  log_string(LOG_INFO, saction + " " +
+                           join(ips, [](auto const &ip) {
+                             return ip.with_subnet();
+                           }, " ") +
+                           " on " + iface);
+  Netlink_socket netlink;
+  netlink.change_addresses(action, netlink.get_link(iface).index, ips);
+  return "";
+}
+
+std::string Drop_port::rule(const Action action) const {
+  return "-" + iptables_action(action) + " INPUT -d " + ip.pure() +
          " -p tcp --syn --dport " + to_string(port) + " -j DROP";
 }
 
-std::string Reject_tp::operator()(const Action action) const {
-  const std::string saction{iptables_action(action)};
+std::string Drop_port::operator()(const Action action) const {
+  return get_iptables_cmd(ip) + " -w " + rule(action);
+}
+
+std::string Reject_tp::rule(const Action action) const {
   auto const stp = tcp_udp == TP::TCP ? std::string{"tcp"} : std::string{"udp"};
-  const std::string iptcmd = get_iptables_cmd(ip);
-  const std::string pip = ip.pure();
-  return iptcmd + " -w -" + saction + " INPUT -d " + pip + " -p " + stp +
-         " -j REJECT";
+  return "-" + iptables_action(action) + " INPUT -d " + ip.pure() + " -p " +
+         stp + " -j REJECT";
 }
 
-std::string Block_icmp::operator()(const Action action) const {
-  const std::string saction{iptables_action(action)};
-  const std::string iptcmd = get_iptables_cmd(ip);
+std::string Reject_tp::operator()(const Action action) const {
+  return get_iptables_cmd(ip) + " -w " + rule(action);
+}
+
+std::string Block_icmp::rule(const Action action) const {
   const std::string icmpv = get_icmp_version(ip);
-  return iptcmd + " -w -" + saction + " OUTPUT -d " + ip.pure() + " -p " +
+  return "-" + iptables_action(action) + " OUTPUT -d " + ip.pure() + " -p " +
          icmpv + " --" + icmpv + "-type destination-unreachable -j DROP";
 }
 
-std::string
-Block_ipv6_neighbor_solicitation::operator()(const Action action) const {
-  const std::string saction{iptables_action(action)};
-  const std::string iptcmd{get_iptables_cmd(ip)};
+std::string Block_icmp::operator()(const Action action) const {
+  return get_iptables_cmd(ip) + " -w " + rule(action);
+}
+
+std::string Block_ipv6_neighbor_solicitation::rule(const Action action) const {
   const std::string ip_rule{ipv6_to_u32_rule(ip)};
 
   // blocks neighbor solicitation for fe80::123
   // ip6tables -I INPUT -s :: -p icmpv6 --icmpv6-type neighbour-solicitation -m
   // u32 --u32 "48=0xfe800000 && 52=0x0 && 56=0x0 && 60=0x123" -j DROP
   // we also need to match the ipv6 address using u32 ip6tables modul
-  return iptcmd + " -w -" + saction +
+  return "-" + iptables_action(action) +
          " INPUT -s :: -p icmpv6 --icmpv6-type neighbour-solicitation" +
          ip_rule + " -j DROP";
 }
+
+std::string
+Block_ipv6_neighbor_solicitation::operator()(const Action action) const {
+  return get_iptables_cmd(ip) + " -w " + rule(action);
+}
+
+Firewall_backend parse_firewall_backend(const std::string &backend) {
+  if (backend == "iptables") {
+    return Firewall_backend::iptables;
+  }
+
+  if (backend == "nftables") {
+    return Firewall_backend::nftables;
+  }
+
+  throw std::invalid_argument("invalid firewall backend: " + backend);
+}
+
+std::ostream &operator<<(std::ostream &out, const Firewall_backend &backend) {
+  switch (backend) {
+  case Firewall_backend::iptables:
+    out << "iptables";
+    break;
+  case Firewall_backend::nftables:
+    out << "nftables";
+    break;
+  default:
+    throw std::runtime_error("invalid firewall backend");
+  }
+  return out;
+}
+
+std::string Firewall_transaction::ruleset(int const family,
+                                          const Action action) const {
+  std::string lines;
+  for (auto const &rule : rules) {
+    std::visit(
+        [&](auto const &r) {
+          if (r.ip.family == family) {
+            lines += r.rule(action) + "\n";
+          }
+        },
+        rule);
+  }
+  if (lines.empty()) {
+    return "";
+  }
+  return "*filter\n" + lines + "COMMIT\n";
+}
+
+std::string Firewall_transaction::operator()(const Action action) const {
+  std::vector<int> changed;
+  try {
+    for (auto const family : {AF_INET, AF_INET6}) {
+      auto const input = ruleset(family, action);
+      if (!input.empty()) {
+        restore(family, input);
+        changed.push_back(family);
+      }
+    }
+  } catch (std::exception const &) {
+    // do not leave the rules of one IP version behind
+    if (action == Action::add) {
+      for (auto const family : changed) {
+        restore(family, ruleset(family, Action::del));
+      }
+    }
+    throw;
+  }
+  return "";
+}
+
+std::string get_nft_table() {
+  // adding and deleting the table first removes what a previous run left
+  return "add table " + nft_table + "\n" + "delete table " + nft_table +
+         "\n" + "table " + nft_table +
+         " {\n"
+         "  set drop_syn4 { type ipv4_addr . inet_service; }\n"
+         "  set drop_syn6 { type ipv6_addr . inet_service; }\n"
+         "  set reject_tcp4 { type ipv4_addr; }\n"
+         "  set reject_tcp6 { type ipv6_addr; }\n"
+         "  set reject_udp4 { type ipv4_addr; }\n"
+         "  set reject_udp6 { type ipv6_addr; }\n"
+         "  set drop_unreachable4 { type ipv4_addr; }\n"
+         "  set drop_unreachable6 { type ipv6_addr; }\n"
+         "  set drop_solicitation { type ipv6_addr; }\n"
+         "  chain input {\n"
+         "    type filter hook input priority filter; policy accept;\n"
+         "    tcp flags & (fin|syn|rst|ack) == syn"
+         " ip daddr . tcp dport @drop_syn4 drop\n"
+         "    tcp flags & (fin|syn|rst|ack) == syn"
+         " ip6 daddr . tcp dport @drop_syn6 drop\n"
+         "    meta l4proto tcp ip daddr @reject_tcp4 reject\n"
+         "    meta l4proto tcp ip6 daddr @reject_tcp6 reject\n"
+         "    meta l4proto udp ip daddr @reject_udp4 reject\n"
+         "    meta l4proto udp ip6 daddr @reject_udp6 reject\n"
+         "    ip6 saddr :: icmpv6 type nd-neighbor-solicit"
+         " icmpv6 taddr @drop_solicitation drop\n"
+         "  }\n"
+         "  chain output {\n"
+         "    type filter hook output priority filter; policy accept;\n"
+         "    icmp type destination-unreachable"
+         " ip daddr @drop_unreachable4 drop\n"
+         "    icmpv6 type destination-unreachable"
+         " ip6 daddr @drop_unreachable6 drop\n"
+         "  }\n"
+         "}\n";
+}
+
+std::string Nft_transaction::ruleset(const Action action) const {
+  auto const command = action == Action::add ? "add" : "delete";
+  std::string lines;
+  for (auto const &rule : rules) {
+    auto const [set, element] =
+        std::visit([](auto const &r) { return nft_element(r); }, rule);
+    lines += std::string{command} + " element " + nft_table + " " + set +
+             " { " + element + " }\n";
+  }
+  return lines;
+}
+
+std::string Nft_transaction::operator()(const Action action) const {
+  // the sets and rules are shared by all hosts, create them only once
+  static std::once_flag table_created;
+  std::call_once(table_created,
+                 [] { apply_ruleset({"nft", "-f", "-"}, get_nft_table()); });
+  auto const input = ruleset(action);
+  if (!input.empty()) {
+    // nft applies a whole file atomically
+    apply_ruleset({"nft", "-f", "-"}, input);
+  }
+  return "";
+}
+
+Scope_guard::Aquire_release
+firewall_transaction(Firewall_backend const backend,
+                     std::vector<Firewall_rule> rules) {
+  if (backend == Firewall_backend::nftables) {
+    return Nft_transaction{.rules = std::move(rules)};
+  }
+  return Firewall_transaction{.rules = std::move(rules)};
+}
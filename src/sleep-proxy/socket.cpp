@@ -78,3 +78,10 @@ ether_addr Socket::get_hwaddr(const std::string &iface) const {
   std::copy(start, end_iter, start_dst);
   return addr;
 }
+
+uint16_t Socket::get_hwtype(const std::string &iface) const {
+  struct ifreq ifr = get_ifreq(iface);
+  ioctl(SIOCGIFHWADDR, ifr);
+  // NOLINTNEXTLINE
+  return ifr.ifr_hwaddr.sa_family;
+}
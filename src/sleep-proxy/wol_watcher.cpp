@@ -15,18 +15,99 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 #include "wol_watcher.h"
+#include "ethernet.h"
 #include "log.h"
-#include "wol.h"
-#include <iterator>
-
-bool is_magic_packet(std::vector<uint8_t> const &data, ether_addr const &mac) {
-  // 1. put the magic pattern into a string
-  std::vector<uint8_t> const packet{create_wol_payload(mac)};
-  std::string const packet_string{std::begin(packet), std::end(packet)};
-  // 2. convert data into a string
-  std::string const data_string{std::begin(data), std::end(data)};
-  // 3. search in data string for the magic pattern with string search
-  return std::string::npos != data_string.find(packet_string);
+#include "magic_packet_scanner.h"
+#include "packet_parser.h"
+#include "to_string.h"
+#include <algorithm>
+#include <iomanip>
+#include <optional>
+#include <span>
+#include <sstream>
+
+namespace {
+std::string const wol_udp_ports = "udp port 0 or udp port 7 or udp port 9";
+std::string const wol_ether_proto = "ether proto 0x0842";
+
+/** 0x followed by count bytes of data in hex */
+std::string to_hex(std::span<uint8_t const> const data) {
+  std::ostringstream hex;
+  hex << "0x" << std::hex << std::setfill('0');
+  for (auto const byte : data) {
+    hex << std::setw(2) << static_cast<unsigned int>(byte);
+  }
+  return hex.str();
+}
+
+/**
+ * compares the sync stream and the first mac of a magic packet starting at
+ * offset of the protocol header proto with macs
+ */
+std::string match_magic_packet(std::string const &proto, size_t const offset,
+                               std::vector<ether_addr> const &macs) {
+  auto const at = [&](size_t const pos, size_t const size) {
+    return proto + "[" + to_string(offset + pos) + ":" + to_string(size) + "]";
+  };
+  auto const match_mac = [&](ether_addr const &mac) {
+    std::span<uint8_t const> const bytes{mac.ether_addr_octet};
+    return "(" + at(6, 4) + " = " + to_hex(bytes.first(4)) + " and " +
+           at(10, 2) + " = " + to_hex(bytes.last(2)) + ")";
+  };
+  return at(0, 4) + " = 0xffffffff and " + at(4, 2) + " = 0xffff and (" +
+         join(macs, match_mac, " or ") + ")";
+}
+
+/** offset of the payload of a link layer header */
+std::optional<size_t> get_link_payload_offset(int const datalink) {
+  switch (datalink) {
+  case DLT_EN10MB:
+    return Link_layer::ethernet_header_size;
+  case DLT_LINUX_SLL:
+    return Link_layer::lcc_header_size;
+  case DLT_LINUX_SLL2:
+    return Link_layer::lcc2_header_size;
+  default:
+    return std::nullopt;
+  }
+}
+} // namespace
+
+std::string get_wol_filter() {
+  return wol_udp_ports + " or " + wol_ether_proto;
+}
+
+std::string get_wol_filter(std::vector<ether_addr> const &macs,
+                           int const datalink) {
+  if (macs.empty()) {
+    return get_wol_filter();
+  }
+  // udp[] only works for IPv4, IPv6 is matched without extension headers
+  static auto const ipv6_udp_payload = size_t{48};
+  static auto const udp_payload = size_t{8};
+  std::string filter = "((" + wol_udp_ports + ") and ((" +
+                       match_magic_packet("udp", udp_payload, macs) +
+                       ") or (ip6 proto 17 and " +
+                       match_magic_packet("ip6", ipv6_udp_payload, macs) +
+                       ")))";
+  auto const link_payload = get_link_payload_offset(datalink);
+  if (link_payload.has_value()) {
+    filter += " or (" + wol_ether_proto + " and " +
+              match_magic_packet("link", *link_payload, macs) + ")";
+  }
+  return filter;
+}
+
+bool is_magic_packet(Packet_view const data, ether_addr const &mac) {
+  for (auto sync = find_sync_stream(data, 0); sync < data.size();
+       sync = find_sync_stream(data, sync + 1)) {
+    auto const found = magic_packet_mac(data, sync);
+    if (found.has_value() &&
+        std::ranges::equal(found->ether_addr_octet, mac.ether_addr_octet)) {
+      return true;
+    }
+  }
+  return false;
 }
 
 void break_on_magic_packet(const struct pcap_pkthdr *header,
@@ -37,10 +118,7 @@ void break_on_magic_packet(const struct pcap_pkthdr *header,
     return;
   }
 
-  const auto *end_iter = packet;
-  std::advance(end_iter, header->len);
-  std::vector<uint8_t> const data{packet, end_iter};
-  if (is_magic_packet(data, mac)) {
+  if (is_magic_packet(to_packet_view(*header, packet), mac)) {
     waiting_for_wol.break_loop(
         Pcap_wrapper::Loop_end_reason::duplicate_address);
   }
@@ -65,9 +143,8 @@ Wol_watcher::Wol_watcher(std::string const &iface, ether_addr macc,
                          Pcap_wrapper &waiting_for_synn)
     : mac(macc), waiting_for_syn(waiting_for_synn), waiting_for_wol{iface},
       wol_listener{} {
-  std::string const filter =
-      "udp port 0 or udp port 7 or udp port 9 or ether proto 0x0842 ";
-  waiting_for_wol.set_filter(filter);
+  waiting_for_wol.set_filter(
+      get_wol_filter({mac}, waiting_for_wol.get_datalink()));
 }
 
 Wol_watcher::~Wol_watcher() { stop(); }
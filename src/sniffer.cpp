@@ -53,10 +53,8 @@ struct Got_packet {
       return;
     }
     log_string(LOG_INFO, *header);
-    const auto *end_iter = packet;
-    std::advance(end_iter, header->len);
     basic_headers headers =
-        get_headers(link_layer_type, std::vector<u_char>(packet, end_iter));
+        get_headers(link_layer_type, to_packet_view(*header, packet));
     log_string(LOG_INFO, headers);
   }
 };
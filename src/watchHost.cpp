@@ -15,13 +15,17 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 #include "args.h"
+#include "capture_engine.h"
 #include "error_suppression.h"
+#include "icmp_prober.h"
 #include "libsleep_proxy.h"
 #include "log.h"
 #include <algorithm>
 #include <csignal>
 #include <cstdlib>
 #include <future>
+#include <map>
+#include <memory>
 #include <span>
 #include <thread>
 
@@ -31,13 +35,13 @@ bool ping_ips(const std::string &iface, const Container &ips) {
   std::vector<std::future<bool>> futures;
   futures.reserve(ips.size());
   for (const auto &ip : ips) {
-    futures.emplace_back(std::async(ping_and_wait, iface, ip, 1));
+    futures.emplace_back(get_icmp_prober().probe(iface, ip));
   }
   return std::any_of(std::begin(futures), std::end(futures),
                      [](std::future<bool> &f) { return f.get(); });
 }
 
-void thread_main(const Host_args &args) {
+void thread_main(const Host_args &args, Host_capture &capture) {
   bool loop = true;
   while (!is_signaled() && loop) {
     log_string(LOG_INFO, "ping " + args.hostname);
@@ -49,7 +53,7 @@ void thread_main(const Host_args &args) {
       return;
     }
     try {
-      Emulate_host_status const status = emulate_host(args);
+      Emulate_host_status const status = emulate_host(args, capture);
       loop = Emulate_host_status::duplicate_address == status ||
              Emulate_host_status::success == status;
     } catch (const std::exception &e) {
@@ -79,10 +83,22 @@ int main(int argc, char *argv[]) {
     if (argss.syslog) {
       setup_log(args[0], 0, LOG_DAEMON);
     }
+    // one capture for all hosts on the same interface
+    std::map<std::string, std::vector<Host_args>> hosts_per_iface;
+    for (auto const &hargs : argss.host_args) {
+      hosts_per_iface[hargs.interface].push_back(hargs);
+    }
+    // engines have to outlive the threads using them
+    std::vector<std::unique_ptr<Capture_engine>> engines;
     std::vector<std::jthread> threads;
     threads.reserve(argss.host_args.size());
-    for (auto const &hargs : argss.host_args) {
-      threads.emplace_back(thread_main, hargs);
+    for (auto const &[iface, hosts] : hosts_per_iface) {
+      auto &engine =
+          engines.emplace_back(std::make_unique<Capture_engine>(iface, hosts));
+      for (size_t i = 0; i < hosts.size(); i++) {
+        threads.emplace_back(thread_main, hosts.at(i),
+                             std::ref(engine->host_capture(i)));
+      }
     }
   } catch (std::exception const &e) {
     log(LOG_ERR, "something wrong: %s\n", e.what());
@@ -38,6 +38,7 @@ void compare(Host_args const &eargs, Host_args const &args) {
   CPPUNIT_ASSERT_EQUAL(eargs.hostname, args.hostname);
   CPPUNIT_ASSERT_EQUAL(eargs.ping_tries, args.ping_tries);
   CPPUNIT_ASSERT_EQUAL(eargs.wol_method, args.wol_method);
+  CPPUNIT_ASSERT_EQUAL(eargs.firewall, args.firewall);
 }
 
 [[nodiscard]] std::vector<IP_address>
@@ -95,10 +96,11 @@ struct Input_args {
   std::string hostname;
   std::string ping_tries;
   std::string wol_method;
+  std::string firewall;
 
   [[nodiscard]] Host_args to_args() const {
     return parse_host_args(interface, addresses, ports, mac, hostname,
-                           ping_tries, wol_method);
+                           ping_tries, wol_method, firewall);
   }
 
   [[nodiscard]] Host_args to_expected() const {
@@ -108,7 +110,8 @@ struct Input_args {
                      mac_to_binary(mac),
                      hostname,
                      static_cast<unsigned int>(std::stoul(ping_tries)),
-                     parse_wol_method(wol_method)};
+                     parse_wol_method(wol_method),
+                     parse_firewall_backend(firewall)};
   }
 
   void compare() const { ::compare(to_expected(), to_args()); }
@@ -124,6 +127,7 @@ class Args_test : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_hostname);
   CPPUNIT_TEST(test_ping_tries);
   CPPUNIT_TEST(test_wol_method);
+  CPPUNIT_TEST(test_firewall);
   CPPUNIT_TEST(test_syslog);
   CPPUNIT_TEST(test_read_file);
   CPPUNIT_TEST(test_print_help);
@@ -142,7 +146,8 @@ class Args_test : public CppUnit::TestFixture {
                         .mac = "1:12:34:45:67:89",
                         .hostname = {},
                         .ping_tries = "5",
-                        .wol_method = "ethernet"};
+                        .wol_method = "ethernet",
+                        .firewall = "iptables"};
 
 public:
   void setUp() override { input_args.compare(); }
@@ -155,6 +160,7 @@ public:
     CPPUNIT_ASSERT_EQUAL(ether_addr{{}}, args.mac);
     CPPUNIT_ASSERT_EQUAL(static_cast<unsigned int>(0), args.ping_tries);
     CPPUNIT_ASSERT_EQUAL(Wol_method::ethernet, args.wol_method);
+    CPPUNIT_ASSERT_EQUAL(Firewall_backend::iptables, args.firewall);
   }
 
   void test_interface() {
@@ -233,6 +239,17 @@ public:
     CPPUNIT_ASSERT_THROW((void)input_args.to_args(), std::invalid_argument);
   }
 
+  void test_firewall() {
+    input_args.firewall = "nftables";
+    input_args.compare();
+    CPPUNIT_ASSERT_EQUAL(Firewall_backend::nftables,
+                         input_args.to_args().firewall);
+    input_args.firewall = "unknown";
+    CPPUNIT_ASSERT_THROW((void)input_args.to_args(), std::invalid_argument);
+    input_args.firewall = "";
+    CPPUNIT_ASSERT_THROW((void)input_args.to_args(), std::invalid_argument);
+  }
+
   static void test_syslog() {
     CPPUNIT_ASSERT(get_args_vec(true).syslog);
     CPPUNIT_ASSERT(!get_args_vec(false).syslog);
@@ -249,7 +266,8 @@ public:
         .mac = "1:12:34:45:67:89",
         .hostname = "test.lan",
         .ping_tries = "5",
-        .wol_method = "ethernet"};
+        .wol_method = "ethernet",
+        .firewall = "iptables"};
     ::compare(arg0.to_expected(), args.host_args.at(0));
 
     Input_args const arg1{
@@ -259,7 +277,8 @@ public:
         .mac = "FF:EE:DD:CC:BB:AA",
         .hostname = "test2",
         .ping_tries = "1",
-        .wol_method = "udp"};
+        .wol_method = "udp",
+        .firewall = "nftables"};
     ::compare(arg1.to_expected(), args.host_args.at(1));
 
     Input_args const arg2{
@@ -269,7 +288,8 @@ public:
         .mac = "1:12:34:45:67:89",
         .hostname = "",
         .ping_tries = "5",
-        .wol_method = "ethernet"};
+        .wol_method = "ethernet",
+        .firewall = "iptables"};
     ::compare(arg2.to_expected(), args.host_args.at(2));
 
     auto args2 = get_args("watchhosts-empty");
@@ -297,7 +317,7 @@ public:
     CPPUNIT_ASSERT_EQUAL(
         std::string("Host_args(interface = , address = , ports = , mac = "
                     "0:0:0:0:0:0, hostname = , print_tries = 0, wol_method = "
-                    "ethernet)"),
+                    "ethernet, firewall = iptables)"),
         ss.str());
   }
 
@@ -309,7 +329,7 @@ public:
             "Host_args(interface = lo, address = fe80::123/64, ports = 12345, "
             "mac = "
             "1:12:34:45:67:89, hostname = , print_tries = 5, wol_method = "
-            "ethernet)"),
+            "ethernet, firewall = iptables)"),
         ss.str());
   }
 
@@ -343,7 +363,7 @@ public:
             "fe80::123/64, ports = 12345, "
             "mac = "
             "1:12:34:45:67:89, hostname = , print_tries = 5, wol_method = "
-            "ethernet)], syslog = false)"),
+            "ethernet, firewall = iptables)], syslog = false)"),
         ss.str());
   }
 
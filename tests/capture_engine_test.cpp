@@ -0,0 +1,219 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "capture_engine.h"
+
+#include "libsleep_proxy.h"
+#include "packet_test_utils.h"
+#include "wol.h"
+#include "wol_watcher.h"
+
+#include <chrono>
+#include <cppunit/extensions/HelperMacros.h>
+#include <future>
+#include <thread>
+
+namespace {
+// ethernet, 127.0.0.1 -> 127.0.0.1, TCP from port 50000 to port 22
+const std::string ethernet_ipv4_tcp_22 =
+    "00000000000000000000000008004500003c88d040004006b3e97f0000017f000001"
+    "c3500016";
+
+// linux cooked capture, 127.0.0.1 -> 127.0.0.1, UDP
+const std::string lcc_ipv4_udp =
+    "000000010006000000000000000008004500003e057f40004011372e7f0000017f000001";
+
+/** ethernet, gratuitous ARP of 02:00:00:00:00:02 for 10.0.0.1 */
+const std::string ethernet_arp_10_0_0_1 = "ffffffffffff020000000002"
+                                          "08060001080006040001"
+                                          "0200000000020a000001"
+                                          "0000000000000a000001";
+
+pcap_pkthdr create_header(size_t packet_length) {
+  const struct pcap_pkthdr header{.ts = {.tv_sec = 0, .tv_usec = 0},
+                                  .caplen = 0,
+                                  .len = static_cast<uint32_t>(packet_length)};
+  return header;
+}
+
+void wait_until_listening(Host_capture &capture) {
+  while (!capture.is_listening()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+}
+} // namespace
+
+class Capture_engine_test : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(Capture_engine_test);
+  CPPUNIT_TEST(test_rule_to_listen_on_hosts);
+  CPPUNIT_TEST(test_lookup_syn);
+  CPPUNIT_TEST(test_lookup_magic_packet);
+  CPPUNIT_TEST(test_lookup_address_claim);
+  CPPUNIT_TEST(test_host_capture_deliver);
+  CPPUNIT_TEST(test_host_capture_break_loop);
+  CPPUNIT_TEST(test_host_capture_pending_break);
+  CPPUNIT_TEST_SUITE_END();
+
+  ether_addr const mac0 = mac_to_binary("01:45:12:78:af:bd");
+  ether_addr const mac1 = mac_to_binary("33:12:ab:de:56:81");
+
+  std::vector<Host_args> const hosts{
+      Host_args{"lo",
+                {parse_ip("10.0.0.1/16")},
+                {80, 22},
+                mac0,
+                "host0",
+                1,
+                Wol_method::ethernet},
+      Host_args{"lo",
+                {parse_ip("127.0.0.1/8"), parse_ip("fe80::1/64")},
+                {22, 443},
+                mac1,
+                "host1",
+                1,
+                Wol_method::ethernet}};
+
+public:
+  void test_rule_to_listen_on_hosts() {
+    CPPUNIT_ASSERT_EQUAL(
+        std::string("(tcp[tcpflags] == tcp-syn and dst host (10.0.0.1 or "
+                    "127.0.0.1 or fe80::1) and dst port (22 or 80 or 443)) "
+                    "or (") +
+            get_wol_filter({mac0, mac1}, DLT_EN10MB) + ") or (" +
+            rule_to_listen_on_address_claims(
+                {parse_ip("10.0.0.1/16"), parse_ip("127.0.0.1/8"),
+                 parse_ip("fe80::1/64")}) +
+            ")",
+        rule_to_listen_on_hosts(hosts, DLT_EN10MB));
+  }
+
+  void test_lookup_syn() {
+    Host_lookup const lookup{hosts};
+    auto const packet = to_binary(ethernet_ipv4_tcp_22);
+    auto const result = lookup(DLT_EN10MB, packet);
+    CPPUNIT_ASSERT(Demux_result::Kind::syn == result.kind);
+    CPPUNIT_ASSERT_EQUAL(size_t{1}, result.host);
+
+    // port is not configured for the host owning the address
+    Host_lookup const other_ports{{Host_args{"lo",
+                                             {parse_ip("127.0.0.1/8")},
+                                             {80},
+                                             mac0,
+                                             "host0",
+                                             1,
+                                             Wol_method::ethernet}}};
+    CPPUNIT_ASSERT(Demux_result::Kind::none ==
+                   other_ports(DLT_EN10MB, packet).kind);
+
+    // address belongs to no host
+    Host_lookup const other_address{{hosts.at(0)}};
+    CPPUNIT_ASSERT(Demux_result::Kind::none ==
+                   other_address(DLT_EN10MB, packet).kind);
+
+    // too short to contain the destination port
+    auto const truncated = to_binary(ethernet_ipv4_tcp_22.substr(0, 74));
+    CPPUNIT_ASSERT(Demux_result::Kind::none ==
+                   lookup(DLT_EN10MB, truncated).kind);
+  }
+
+  void test_lookup_magic_packet() {
+    Host_lookup const lookup{hosts};
+    auto const packet0 = to_binary(lcc_ipv4_udp) + create_wol_payload(mac0);
+    auto const result0 = lookup(DLT_LINUX_SLL, packet0);
+    CPPUNIT_ASSERT(Demux_result::Kind::magic_packet == result0.kind);
+    CPPUNIT_ASSERT_EQUAL(size_t{0}, result0.host);
+
+    auto const packet1 = to_binary(lcc_ipv4_udp) + create_wol_payload(mac1);
+    auto const result1 = lookup(DLT_LINUX_SLL, packet1);
+    CPPUNIT_ASSERT(Demux_result::Kind::magic_packet == result1.kind);
+    CPPUNIT_ASSERT_EQUAL(size_t{1}, result1.host);
+
+    auto const other_mac =
+        to_binary(lcc_ipv4_udp) +
+        create_wol_payload(mac_to_binary("00:11:22:33:44:55"));
+    CPPUNIT_ASSERT(Demux_result::Kind::none ==
+                   lookup(DLT_LINUX_SLL, other_mac).kind);
+  }
+
+  void test_lookup_address_claim() {
+    Host_lookup const lookup{hosts};
+    auto const packet = to_binary(ethernet_arp_10_0_0_1);
+    auto const result = lookup(DLT_EN10MB, packet);
+    CPPUNIT_ASSERT(Demux_result::Kind::address_claim == result.kind);
+    CPPUNIT_ASSERT_EQUAL(size_t{0}, result.host);
+
+    // address belongs to no host
+    Host_lookup const other_address{{hosts.at(1)}};
+    CPPUNIT_ASSERT(Demux_result::Kind::none ==
+                   other_address(DLT_EN10MB, packet).kind);
+  }
+
+  void test_host_capture_deliver() {
+    Host_capture capture{DLT_EN10MB};
+    CPPUNIT_ASSERT_EQUAL(DLT_EN10MB, capture.get_datalink());
+    CPPUNIT_ASSERT(!capture.is_listening());
+
+    auto const packet = to_binary(ethernet_ipv4_tcp_22);
+    auto const header = create_header(packet.size());
+    // nobody is waiting for packets
+    CPPUNIT_ASSERT(!capture.deliver(&header, packet.data()));
+
+    std::vector<uint8_t> received;
+    auto const cb = [&](const pcap_pkthdr *hdr, const u_char *data) {
+      received.assign(data, data + hdr->len);
+    };
+    auto ler =
+        std::async(std::launch::async, [&] { return capture.loop(1, cb); });
+    wait_until_listening(capture);
+    CPPUNIT_ASSERT(capture.deliver(&header, packet.data()));
+    CPPUNIT_ASSERT(Pcap_wrapper::Loop_end_reason::packets_captured ==
+                   ler.get());
+    CPPUNIT_ASSERT(packet == received);
+    CPPUNIT_ASSERT(!capture.is_listening());
+  }
+
+  void test_host_capture_break_loop() {
+    Host_capture capture{DLT_EN10MB};
+    auto ler = std::async(std::launch::async, [&] {
+      return capture.loop(1, [](const pcap_pkthdr *, const u_char *) {});
+    });
+    wait_until_listening(capture);
+    capture.break_loop(Pcap_wrapper::Loop_end_reason::duplicate_address);
+    CPPUNIT_ASSERT(Pcap_wrapper::Loop_end_reason::duplicate_address ==
+                   ler.get());
+  }
+
+  void test_host_capture_pending_break() {
+    Host_capture capture{DLT_EN10MB};
+    auto const cb = [](const pcap_pkthdr *, const u_char *) {};
+
+    // a break before loop() ends the next loop() immediately
+    capture.break_loop(Pcap_wrapper::Loop_end_reason::signal);
+    CPPUNIT_ASSERT(Pcap_wrapper::Loop_end_reason::signal ==
+                   capture.loop(1, cb));
+
+    // reset() drops a pending break
+    capture.break_loop(Pcap_wrapper::Loop_end_reason::duplicate_address);
+    capture.reset();
+    auto ler =
+        std::async(std::launch::async, [&] { return capture.loop(1, cb); });
+    wait_until_listening(capture);
+    capture.break_loop(Pcap_wrapper::Loop_end_reason::signal);
+    CPPUNIT_ASSERT(Pcap_wrapper::Loop_end_reason::signal == ler.get());
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(Capture_engine_test);
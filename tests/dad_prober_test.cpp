@@ -0,0 +1,254 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "dad_prober.h"
+
+#include "packet_test_utils.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <linux/if_packet.h>
+#include <net/ethernet.h>
+#include <netinet/icmp6.h>
+
+namespace {
+std::string const own_mac = "02:00:00:00:00:01";
+std::string const other_mac = "02:00:00:00:00:02";
+
+std::string const arp_probe = "0001080006040001"
+                              "020000000001"
+                              "00000000"
+                              "000000000000"
+                              "7f010203";
+
+/** ARP reply of other_mac for 127.1.2.3 */
+std::string const arp_reply = "0001080006040002"
+                              "020000000002"
+                              "7f010203"
+                              "020000000001"
+                              "00000000";
+
+/** Neighbor Advertisement of other_mac for fd00::1234 */
+std::string const advertisement = "8800000060000000"
+                                  "fd000000000000000000000000001234"
+                                  "0201020000000002";
+
+/** ARP request of other_mac for the gateway 127.0.0.1 from 127.1.2.3 */
+std::string const arp_request = "0001080006040001"
+                                "020000000002"
+                                "7f010203"
+                                "000000000000"
+                                "7f000001";
+
+/** arp_reply in an ethernet frame with VLAN tag */
+std::string const ethernet_vlan_arp_reply = "020000000001"
+                                            "020000000002"
+                                            "810000010806" +
+                                            arp_reply;
+
+/**
+ * linux cooked capture of advertisement without the target link-layer address
+ * option, sent by other_mac from fe80::2 to ff02::1
+ */
+std::string const lcc_advertisement = "0000000100060200000000020000"
+                                      "86dd"
+                                      "6000000000183aff"
+                                      "fe800000000000000000000000000002"
+                                      "ff020000000000000000000000000001" +
+                                      advertisement.substr(0, 48);
+
+/** frames sent on lo are received as well */
+void send_on_lo(std::vector<uint8_t> const &payload, uint16_t const protocol) {
+  Socket sock{AF_PACKET, SOCK_DGRAM, htons(protocol)};
+  sockaddr_ll const lo{.sll_family = AF_PACKET,
+                       .sll_protocol = htons(protocol),
+                       .sll_ifindex = sock.get_ifindex("lo"),
+                       .sll_hatype = 0,
+                       .sll_pkttype = 0,
+                       .sll_halen = ETH_ALEN,
+                       .sll_addr = {}};
+  sock.send_to(payload, 0, lo);
+}
+
+} // namespace
+
+class Dad_prober_test : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(Dad_prober_test);
+  CPPUNIT_TEST(test_create_arp_probe);
+  CPPUNIT_TEST(test_parse_arp_reply);
+  CPPUNIT_TEST(test_parse_arp_sender);
+  CPPUNIT_TEST(test_create_neighbor_solicitation);
+  CPPUNIT_TEST(test_parse_neighbor_advertisement);
+  CPPUNIT_TEST(test_get_address_claim);
+  CPPUNIT_TEST(test_get_solicited_node_address);
+  CPPUNIT_TEST(test_probe_timeout);
+  CPPUNIT_TEST(test_probe_arp_reply);
+  CPPUNIT_TEST(test_probe_own_arp_reply);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  static void test_create_arp_probe() {
+    CPPUNIT_ASSERT(to_binary(arp_probe) ==
+                   create_arp_probe(mac_to_binary(own_mac),
+                                    parse_ip("127.1.2.3")));
+    CPPUNIT_ASSERT_THROW((void)create_arp_probe(mac_to_binary(own_mac),
+                                                parse_ip("::1")),
+                         std::invalid_argument);
+  }
+
+  static void test_parse_arp_reply() {
+    auto const neighbor = parse_arp_reply(to_binary(arp_reply));
+    CPPUNIT_ASSERT(neighbor.has_value());
+    CPPUNIT_ASSERT_EQUAL(parse_ip("127.1.2.3").host(), neighbor->ip);
+    CPPUNIT_ASSERT_EQUAL(mac_to_binary(other_mac), neighbor->mac);
+
+    // requests, truncated replies and other protocols are no replies
+    CPPUNIT_ASSERT(!parse_arp_reply(to_binary(arp_probe)).has_value());
+    CPPUNIT_ASSERT(
+        !parse_arp_reply(to_binary(arp_reply.substr(0, 54))).has_value());
+    auto ipv6_reply = to_binary(arp_reply);
+    ipv6_reply.at(2) = 0x86;
+    CPPUNIT_ASSERT(!parse_arp_reply(ipv6_reply).has_value());
+    CPPUNIT_ASSERT(!parse_arp_reply({}).has_value());
+  }
+
+  static void test_parse_arp_sender() {
+    auto const reply = parse_arp_sender(to_binary(arp_reply));
+    CPPUNIT_ASSERT(reply.has_value());
+    CPPUNIT_ASSERT_EQUAL(parse_ip("127.1.2.3").host(), reply->ip);
+    CPPUNIT_ASSERT_EQUAL(mac_to_binary(other_mac), reply->mac);
+
+    // any request of a node tells which address it uses
+    auto const request = parse_arp_sender(to_binary(arp_request));
+    CPPUNIT_ASSERT(request.has_value());
+    CPPUNIT_ASSERT_EQUAL(parse_ip("127.1.2.3").host(), request->ip);
+    CPPUNIT_ASSERT_EQUAL(mac_to_binary(other_mac), request->mac);
+
+    // probes have no sender address
+    CPPUNIT_ASSERT(!parse_arp_sender(to_binary(arp_probe)).has_value());
+    CPPUNIT_ASSERT(!parse_arp_sender({}).has_value());
+  }
+
+  static void test_create_neighbor_solicitation() {
+    CPPUNIT_ASSERT(to_binary("8700000000000000"
+                             "fd000000000000000000000000001234"
+                             "0101020000000001") ==
+                   create_neighbor_solicitation(mac_to_binary(own_mac),
+                                                parse_ip("fd00::1234")));
+    CPPUNIT_ASSERT_THROW((void)create_neighbor_solicitation(
+                             mac_to_binary(own_mac), parse_ip("10.0.0.1")),
+                         std::invalid_argument);
+  }
+
+  static void test_parse_neighbor_advertisement() {
+    auto const neighbor =
+        parse_neighbor_advertisement(to_binary(advertisement));
+    CPPUNIT_ASSERT(neighbor.has_value());
+    CPPUNIT_ASSERT_EQUAL(parse_ip("fd00::1234").host(), neighbor->ip);
+    CPPUNIT_ASSERT_EQUAL(mac_to_binary(other_mac), neighbor->mac);
+
+    // without target link-layer address option
+    auto const without_mac =
+        parse_neighbor_advertisement(to_binary(advertisement.substr(0, 48)));
+    CPPUNIT_ASSERT(without_mac.has_value());
+    CPPUNIT_ASSERT_EQUAL(ether_addr{}, without_mac->mac);
+
+    // an option claiming to be longer than the packet is ignored
+    auto const broken_option = parse_neighbor_advertisement(
+        to_binary(advertisement.substr(0, 48) + "0202020000000002"));
+    CPPUNIT_ASSERT(broken_option.has_value());
+    CPPUNIT_ASSERT_EQUAL(ether_addr{}, broken_option->mac);
+
+    CPPUNIT_ASSERT(!parse_neighbor_advertisement(
+                        to_binary("8700000000000000"
+                                  "fd000000000000000000000000001234"))
+                        .has_value());
+    CPPUNIT_ASSERT(
+        !parse_neighbor_advertisement(to_binary(advertisement.substr(0, 46)))
+             .has_value());
+  }
+
+  static void test_get_address_claim() {
+    auto const frame = to_binary(ethernet_vlan_arp_reply);
+    auto const arp = get_address_claim(get_headers(DLT_EN10MB, frame), frame);
+    CPPUNIT_ASSERT(arp.has_value());
+    CPPUNIT_ASSERT_EQUAL(parse_ip("127.1.2.3").host(), arp->ip);
+    CPPUNIT_ASSERT_EQUAL(mac_to_binary(other_mac), arp->mac);
+
+    // the sender claims the target without its link-layer address
+    auto const capture = to_binary(lcc_advertisement);
+    auto const advertised =
+        get_address_claim(get_headers(DLT_LINUX_SLL, capture), capture);
+    CPPUNIT_ASSERT(advertised.has_value());
+    CPPUNIT_ASSERT_EQUAL(parse_ip("fd00::1234").host(), advertised->ip);
+    CPPUNIT_ASSERT_EQUAL(mac_to_binary(other_mac), advertised->mac);
+
+    // a neighbor solicitation claims nothing
+    auto solicitation = capture;
+    solicitation.at(56) = ND_NEIGHBOR_SOLICIT;
+    CPPUNIT_ASSERT(
+        !get_address_claim(get_headers(DLT_LINUX_SLL, solicitation),
+                           solicitation)
+             .has_value());
+
+    // truncated ARP packet
+    auto const truncated = to_binary(ethernet_vlan_arp_reply.substr(0, 60));
+    CPPUNIT_ASSERT(
+        !get_address_claim(get_headers(DLT_EN10MB, truncated), truncated)
+             .has_value());
+  }
+
+  static void test_get_solicited_node_address() {
+    CPPUNIT_ASSERT_EQUAL(parse_ip("ff02::1:ff00:1234").host(),
+                         get_solicited_node_address(parse_ip("fd00::1234")));
+    CPPUNIT_ASSERT_EQUAL(
+        parse_ip("ff02::1:ffcd:ef01").host(),
+        get_solicited_node_address(parse_ip("fe80::abcd:ef01/64")));
+  }
+
+  static void test_probe_timeout() {
+    Dad_prober prober;
+    auto const timeout = std::chrono::milliseconds{50};
+    CPPUNIT_ASSERT(!prober
+                        .probe("lo", parse_ip("127.1.2.3"),
+                               mac_to_binary(own_mac), timeout)
+                        .get());
+    // lo does not support multicast, the probe fails at once
+    CPPUNIT_ASSERT(!prober
+                        .probe("lo", parse_ip("fd00::1234"),
+                               mac_to_binary(own_mac), timeout)
+                        .get());
+  }
+
+  static void test_probe_arp_reply() {
+    Dad_prober prober;
+    auto occupied = prober.probe("lo", parse_ip("127.1.2.3"),
+                                 mac_to_binary(own_mac));
+    send_on_lo(to_binary(arp_reply), ETH_P_ARP);
+    CPPUNIT_ASSERT(occupied.get());
+  }
+
+  static void test_probe_own_arp_reply() {
+    Dad_prober prober;
+    auto occupied =
+        prober.probe("lo", parse_ip("127.1.2.3"), mac_to_binary(other_mac),
+                     std::chrono::milliseconds{200});
+    // the reply of the node itself does not count
+    send_on_lo(to_binary(arp_reply), ETH_P_ARP);
+    CPPUNIT_ASSERT(!occupied.get());
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(Dad_prober_test);
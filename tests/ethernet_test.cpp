@@ -32,6 +32,12 @@ const std::string lcc_ipv4_1_wireshark = "00000001000660606060606000000800";
 const std::string lcc_ipv4_2_wireshark = "00000001000860606060606012340800";
 const std::string lcc_ipv4_3_wireshark = "00000001000960606060606000000800";
 const std::string lcc_ipv6_0_wireshark = "000000010006616263646566000086dd";
+const std::string lcc2_ipv4_wireshark =
+    "0800000000000002000100066060606060600000";
+const std::string lcc2_not_supported_ipv4_wireshark =
+    "0800000000000002030500066060606060600000";
+const std::string lcc2_ipv4_halen_wireshark =
+    "0800000000000002000100086060606060601234";
 const std::string vlan_ipv4_wireshark = "00010800";
 const std::string vlan_ipv6_wireshark = "000186dd";
 static auto const byte_size = 8;
@@ -47,6 +53,10 @@ class Ethernet_test : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_parse_lcc_ipv4_2);
   CPPUNIT_TEST(test_parse_lcc_ipv4_3);
   CPPUNIT_TEST(test_parse_lcc_ipv6);
+  CPPUNIT_TEST(test_parse_lcc2_ipv4);
+  CPPUNIT_TEST(test_parse_lcc2_not_supported);
+  CPPUNIT_TEST(test_parse_lcc2_invalid_address_length);
+  CPPUNIT_TEST(test_parse_lcc2_ipv4_too_short);
   CPPUNIT_TEST(test_parse_ethernet_ipv4);
   CPPUNIT_TEST(test_parse_ethernet_ipv4_1);
   CPPUNIT_TEST(test_parse_ethernet_ipv6);
@@ -74,6 +84,11 @@ class Ethernet_test : public CppUnit::TestFixture {
   const std::vector<uint8_t> lcc_ipv4_2 = to_binary(lcc_ipv4_2_wireshark);
   const std::vector<uint8_t> lcc_ipv4_3 = to_binary(lcc_ipv4_3_wireshark);
   const std::vector<uint8_t> lcc_ipv6_0 = to_binary(lcc_ipv6_0_wireshark);
+  const std::vector<uint8_t> lcc2_ipv4 = to_binary(lcc2_ipv4_wireshark);
+  const std::vector<uint8_t> lcc2_not_supported =
+      to_binary(lcc2_not_supported_ipv4_wireshark);
+  const std::vector<uint8_t> lcc2_ipv4_halen =
+      to_binary(lcc2_ipv4_halen_wireshark);
   const std::vector<uint8_t> ethernet_ipv4_0 =
       to_binary(ethernet_ipv4_0_wireshark);
   const std::vector<uint8_t> ethernet_ipv4_1 =
@@ -142,6 +157,35 @@ public:
             "Linux cooked capture: src: 61:62:63:64:65:66");
   }
 
+  void test_parse_lcc2_ipv4() {
+    auto ll = parse_link_layer(DLT_LINUX_SLL2, std::begin(lcc2_ipv4),
+                               std::end(lcc2_ipv4));
+    test_ll(ll, Link_layer::lcc2_header_size, "60:60:60:60:60:60",
+            Payload_protocol::ipv4,
+            "Linux cooked capture: src: 60:60:60:60:60:60");
+  }
+
+  void test_parse_lcc2_not_supported() {
+    CPPUNIT_ASSERT_THROW((void)parse_link_layer(DLT_LINUX_SLL2,
+                                                std::begin(lcc2_not_supported),
+                                                std::end(lcc2_not_supported)),
+                         std::runtime_error);
+  }
+
+  void test_parse_lcc2_invalid_address_length() {
+    CPPUNIT_ASSERT_THROW((void)parse_link_layer(DLT_LINUX_SLL2,
+                                                std::begin(lcc2_ipv4_halen),
+                                                std::end(lcc2_ipv4_halen)),
+                         std::length_error);
+  }
+
+  void test_parse_lcc2_ipv4_too_short() {
+    CPPUNIT_ASSERT_THROW((void)parse_link_layer(DLT_LINUX_SLL2,
+                                                std::begin(lcc2_ipv4),
+                                                std::end(lcc2_ipv4) - 1),
+                         std::length_error);
+  }
+
   void test_parse_ethernet_ipv4() {
     auto ll = parse_link_layer(DLT_EN10MB, std::begin(ethernet_ipv4_0),
                                std::end(ethernet_ipv4_0));
@@ -258,12 +302,13 @@ public:
     std::vector<uint8_t> data;
     static auto const max_type = uint16_t{0xFFFF};
     for (int type = 0; type < max_type; type++) {
-      if (type == DLT_LINUX_SLL || type == DLT_EN10MB ||
-          type == ETHERTYPE_VLAN) {
+      if (type == DLT_LINUX_SLL || type == DLT_LINUX_SLL2 ||
+          type == DLT_EN10MB || type == ETHERTYPE_VLAN) {
         continue;
       }
-      CPPUNIT_ASSERT(std::unique_ptr<Link_layer>(nullptr) ==
-                     parse_link_layer(type, std::begin(data), std::end(data)));
+      CPPUNIT_ASSERT(
+          !parse_link_layer(type, std::begin(data), std::end(data))
+               .has_value());
     }
   }
 
@@ -0,0 +1,107 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "icmp_prober.h"
+
+#include "packet_test_utils.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+
+namespace {
+auto const echo = Echo_id{.id = 0x1234, .sequence = 1};
+
+std::string const ipv4_header = "4500001c00000000400100007f0000017f000001";
+} // namespace
+
+class Icmp_prober_test : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(Icmp_prober_test);
+  CPPUNIT_TEST(test_create_echo_request);
+  CPPUNIT_TEST(test_parse_echo_reply);
+  CPPUNIT_TEST(test_parse_no_echo_reply);
+  CPPUNIT_TEST(test_probe_loopback);
+  CPPUNIT_TEST(test_probe_many);
+  CPPUNIT_TEST(test_probe_timeout);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  static void test_create_echo_request() {
+    CPPUNIT_ASSERT(to_binary("0800e5ca12340001") ==
+                   create_echo_request(AF_INET, echo));
+    // the kernel fills in the checksum
+    CPPUNIT_ASSERT(to_binary("8000000012340001") ==
+                   create_echo_request(AF_INET6, echo));
+  }
+
+  static void test_parse_echo_reply() {
+    auto const ipv4 = to_binary(ipv4_header + "0000edca12340001");
+    CPPUNIT_ASSERT(echo == parse_echo_reply(AF_INET, ipv4));
+    auto const ipv6 = to_binary("8100000012340001");
+    CPPUNIT_ASSERT(echo == parse_echo_reply(AF_INET6, ipv6));
+  }
+
+  static void test_parse_no_echo_reply() {
+    // echo requests
+    auto const request = to_binary(ipv4_header + "0800e5ca12340001");
+    CPPUNIT_ASSERT(!parse_echo_reply(AF_INET, request).has_value());
+    CPPUNIT_ASSERT(
+        !parse_echo_reply(AF_INET6, to_binary("8000000012340001")).has_value());
+    // too short
+    CPPUNIT_ASSERT(
+        !parse_echo_reply(AF_INET, to_binary(ipv4_header + "0000edca1234"))
+             .has_value());
+    CPPUNIT_ASSERT(
+        !parse_echo_reply(AF_INET, to_binary(ipv4_header)).has_value());
+    CPPUNIT_ASSERT(!parse_echo_reply(AF_INET, {}).has_value());
+    CPPUNIT_ASSERT(
+        !parse_echo_reply(AF_INET6, to_binary("810000001234")).has_value());
+    // IPv4 socket without IP header
+    CPPUNIT_ASSERT(
+        !parse_echo_reply(AF_INET, to_binary("0000edca12340001")).has_value());
+  }
+
+  static void test_probe_loopback() {
+    Icmp_prober prober;
+    CPPUNIT_ASSERT(prober.probe("lo", parse_ip("127.0.0.1")).get());
+    CPPUNIT_ASSERT(prober.probe("lo", parse_ip("::1")).get());
+    // only link local addresses need the interface
+    CPPUNIT_ASSERT(prober.probe("eth0", parse_ip("127.0.0.1")).get());
+  }
+
+  static void test_probe_many() {
+    Icmp_prober prober;
+    std::vector<std::future<bool>> replies;
+    for (int i = 0; i < 100; i++) {
+      replies.emplace_back(prober.probe("lo", parse_ip("127.0.0.1")));
+      replies.emplace_back(prober.probe("lo", parse_ip("::1")));
+    }
+    for (auto &reply : replies) {
+      CPPUNIT_ASSERT(reply.get());
+    }
+  }
+
+  static void test_probe_timeout() {
+    Icmp_prober prober;
+    auto const timeout = std::chrono::milliseconds{100};
+    // nobody answers from TEST-NET-2
+    auto silent = prober.probe("lo", parse_ip("198.51.100.1"), timeout);
+    auto alive = prober.probe("lo", parse_ip("127.0.0.1"), timeout);
+    CPPUNIT_ASSERT(alive.get());
+    CPPUNIT_ASSERT(!prober.probe("lo", parse_ip("2001:db8::1"), timeout).get());
+    CPPUNIT_ASSERT(!silent.get());
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(Icmp_prober_test);
@@ -19,11 +19,17 @@
 #include "to_string.h"
 
 #include <cppunit/extensions/HelperMacros.h>
+#include <cstring>
+#include <unordered_set>
 
 class Ip_address_test : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(Ip_address_test);
   CPPUNIT_TEST(test_parse_ip);
   CPPUNIT_TEST(test_stream_operator);
+  CPPUNIT_TEST(test_equality);
+  CPPUNIT_TEST(test_ordering);
+  CPPUNIT_TEST(test_hash);
+  CPPUNIT_TEST(test_host);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -75,6 +81,59 @@ public:
     ss << ipa;
     CPPUNIT_ASSERT_EQUAL(std::string("192.168.1.2/23"), ss.str());
   }
+
+  static void test_equality() {
+    CPPUNIT_ASSERT(parse_ip("192.168.1.2/24") == parse_ip("192.168.1.2"));
+    CPPUNIT_ASSERT(parse_ip("fe80::1%lo") == parse_ip("fe80:0::1/64"));
+    CPPUNIT_ASSERT(parse_ip("192.168.1.2") != parse_ip("192.168.1.3"));
+    CPPUNIT_ASSERT(parse_ip("192.168.1.2/24") != parse_ip("192.168.1.2/16"));
+    CPPUNIT_ASSERT(parse_ip("::1") != parse_ip("::2"));
+    // only the used part of the address is compared
+    IP_address ipv4{};
+    std::memset(&ipv4.address, 0xff, sizeof(ipv4.address));
+    ipv4.family = AF_INET;
+    ipv4.address.ipv4 = parse_ip("10.0.0.1").address.ipv4;
+    ipv4.subnet = parse_ip("10.0.0.1").subnet;
+    CPPUNIT_ASSERT(ipv4 == parse_ip("10.0.0.1"));
+    CPPUNIT_ASSERT_EQUAL(size_t{4}, ipv4.bytes().size());
+    CPPUNIT_ASSERT_EQUAL(size_t{16}, parse_ip("::1").bytes().size());
+  }
+
+  static void test_ordering() {
+    CPPUNIT_ASSERT(parse_ip("10.0.0.1") < parse_ip("10.0.0.2"));
+    CPPUNIT_ASSERT(parse_ip("9.0.0.1") < parse_ip("10.0.0.1"));
+    CPPUNIT_ASSERT(parse_ip("10.0.0.1/8") < parse_ip("10.0.0.1/16"));
+    CPPUNIT_ASSERT(parse_ip("255.255.255.255") < parse_ip("::"));
+    CPPUNIT_ASSERT(parse_ip("fe80::1") > parse_ip("2001::1"));
+    CPPUNIT_ASSERT(parse_ip("::1") <= parse_ip("::1"));
+    CPPUNIT_ASSERT(std::strong_ordering::equal ==
+                   (parse_ip("::1") <=> parse_ip("::1")));
+  }
+
+  static void test_hash() {
+    std::hash<IP_address> const hash{};
+    CPPUNIT_ASSERT_EQUAL(hash(parse_ip("10.0.0.1/24")),
+                         hash(parse_ip("10.0.0.1")));
+    CPPUNIT_ASSERT(hash(parse_ip("10.0.0.1")) != hash(parse_ip("10.0.0.2")));
+    CPPUNIT_ASSERT(hash(parse_ip("10.0.0.1/24")) !=
+                   hash(parse_ip("10.0.0.1/16")));
+    CPPUNIT_ASSERT(hash(parse_ip("::1")) != hash(parse_ip("::2")));
+
+    std::unordered_set<IP_address> const ips{
+        parse_ip("10.0.0.1"), parse_ip("fe80::1"), parse_ip("10.0.0.1/24")};
+    CPPUNIT_ASSERT_EQUAL(size_t{2}, ips.size());
+    CPPUNIT_ASSERT(ips.contains(parse_ip("fe80::1/64")));
+    CPPUNIT_ASSERT(!ips.contains(parse_ip("fe80::1/128")));
+  }
+
+  static void test_host() {
+    auto const ipv4 = parse_ip("10.0.0.1/8").host();
+    CPPUNIT_ASSERT_EQUAL(std::string("10.0.0.1/32"), ipv4.with_subnet());
+    CPPUNIT_ASSERT_EQUAL(AF_INET, ipv4.family);
+    auto const ipv6 = parse_ip("fe80::1").host();
+    CPPUNIT_ASSERT_EQUAL(std::string("fe80::1/128"), ipv6.with_subnet());
+    CPPUNIT_ASSERT_EQUAL(ipv6, ipv6.host());
+  }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(Ip_address_test);
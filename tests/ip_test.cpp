@@ -115,22 +115,23 @@ public:
 
   void test_wrong_ip_version_ipv4() {
     CPPUNIT_ASSERT(
-        std::unique_ptr<ip>(nullptr) ==
-        parse_ip(ip::ipv6, std::begin(ipv4_tcp_0), std::end(ipv4_tcp_0)));
+        !parse_ip(ip::ipv6, std::begin(ipv4_tcp_0), std::end(ipv4_tcp_0))
+             .has_value());
   }
 
   void test_wrong_ip_version_ipv6() {
     CPPUNIT_ASSERT(
-        std::unique_ptr<ip>(nullptr) ==
-        parse_ip(ip::ipv4, std::begin(ipv6_udp), std::end(ipv6_udp)));
+        !parse_ip(ip::ipv4, std::begin(ipv6_udp), std::end(ipv6_udp))
+             .has_value());
   }
 
   void test_unknown_ip_version() {
     static auto const numbers_to_test = uint8_t{20};
     for (uint16_t i = 0; i < numbers_to_test; i++) {
       CPPUNIT_ASSERT(ip::ipv4 != i && ip::ipv6 != i);
-      CPPUNIT_ASSERT(std::unique_ptr<ip>(nullptr) ==
-                     parse_ip(i, std::begin(ipv4_tcp_0), std::end(ipv4_tcp_0)));
+      CPPUNIT_ASSERT(
+          !parse_ip(i, std::begin(ipv4_tcp_0), std::end(ipv4_tcp_0))
+               .has_value());
     }
   }
   void test_stream_operator() {
@@ -16,11 +16,16 @@
 
 #include "libsleep_proxy.h"
 
+#include "capture_engine.h"
 #include "container_utils.h"
+#include "ethernet.h"
 #include "ip_utils.h"
 
+#include <chrono>
 #include <cppunit/extensions/HelperMacros.h>
 #include <csignal>
+#include <future>
+#include <thread>
 
 class Libsleep_proxy_test : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(Libsleep_proxy_test);
@@ -29,6 +34,11 @@ class Libsleep_proxy_test : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_ping_and_wait);
   CPPUNIT_TEST(test_get_bindable_ip);
   CPPUNIT_TEST(test_rule_to_listen_on_ips_and_ports);
+  CPPUNIT_TEST(test_rule_to_listen_on_address_claims);
+  CPPUNIT_TEST(test_get_host_up_filter);
+  CPPUNIT_TEST(test_wait_until_up_frame);
+  CPPUNIT_TEST(test_wait_until_up_ping);
+  CPPUNIT_TEST(test_wait_until_up_nothing);
   CPPUNIT_TEST_SUITE_END();
 
 public:
@@ -78,7 +88,9 @@ public:
   }
 
   static std::vector<IP_address> parse_ips(const std::string &ips) {
-    return parse_items(split(ips, ','), parse_ip);
+    return parse_items(split(ips, ','), [](std::string const &ip) {
+      return parse_ip(ip);
+    });
   }
 
   static void test_rule_to_listen_on_ips_and_ports() {
@@ -106,6 +118,58 @@ public:
     CPPUNIT_ASSERT_EQUAL(expected_rule,
                          rule_to_listen_on_ips_and_ports(ips, ports));
   }
+
+  static void test_rule_to_listen_on_address_claims() {
+    CPPUNIT_ASSERT_EQUAL(
+        std::string("inbound and (arp src host (192.168.1.1 or 10.0.0.1))"),
+        rule_to_listen_on_address_claims(parse_ips("192.168.1.1,10.0.0.1")));
+    CPPUNIT_ASSERT_EQUAL(
+        std::string("inbound and (arp src host (192.168.1.1) or (icmp6 and "
+                    "ip6[40] = 136 and ((ip6[48:4] = 0x20010db8 and "
+                    "ip6[52:4] = 0x00000000 and ip6[56:4] = 0x00000000 and "
+                    "ip6[60:4] = 0x000000ff))))"),
+        rule_to_listen_on_address_claims(
+            parse_ips("192.168.1.1,2001:db8::ff/64")));
+  }
+
+  static void test_get_host_up_filter() {
+    CPPUNIT_ASSERT_EQUAL(
+        std::string("ether src 1:23:45:67:89:ab"),
+        get_host_up_filter(mac_to_binary("01:23:45:67:89:ab")));
+  }
+
+  static void test_wait_until_up_frame() {
+    Host_capture frames{DLT_EN10MB};
+    // nobody answers pings from TEST-NET-2, but the frame arrives first
+    auto up = std::async(std::launch::async, [&] {
+      return wait_until_up(frames, "lo", parse_ip("198.51.100.1"), 1);
+    });
+    while (!frames.is_listening()) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto const frame = create_ethernet_header(
+        mac_to_binary("ff:ff:ff:ff:ff:ff"), mac_to_binary("01:23:45:67:89:ab"),
+        ETHERTYPE_ARP);
+    pcap_pkthdr header{};
+    header.len = static_cast<bpf_u_int32>(frame.size());
+    header.caplen = header.len;
+    CPPUNIT_ASSERT(frames.deliver(&header, frame.data()));
+    CPPUNIT_ASSERT(std::future_status::ready ==
+                   up.wait_for(std::chrono::seconds(1)));
+    CPPUNIT_ASSERT(up.get());
+  }
+
+  static void test_wait_until_up_ping() {
+    Host_capture frames{DLT_EN10MB};
+    CPPUNIT_ASSERT(wait_until_up(frames, "lo", parse_ip("127.0.0.1"), 1));
+    CPPUNIT_ASSERT(!frames.is_listening());
+  }
+
+  static void test_wait_until_up_nothing() {
+    Host_capture frames{DLT_EN10MB};
+    CPPUNIT_ASSERT(!wait_until_up(frames, "lo", parse_ip("127.0.0.1"), 0));
+    CPPUNIT_ASSERT(!frames.is_listening());
+  }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(Libsleep_proxy_test);
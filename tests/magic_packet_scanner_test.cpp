@@ -0,0 +1,182 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "magic_packet_scanner.h"
+
+#include "packet_test_utils.h"
+#include "wol.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <limits>
+#include <random>
+
+namespace {
+std::vector<Simd_level> const levels{Simd_level::scalar, Simd_level::sse2,
+                                     Simd_level::avx2};
+
+std::vector<uint8_t> gen_random_data(size_t const size,
+                                     std::default_random_engine &generator) {
+  std::uniform_int_distribution<uint8_t> distribution(
+      std::numeric_limits<uint8_t>::min(), std::numeric_limits<uint8_t>::max());
+  std::vector<uint8_t> data(size);
+  for (uint8_t &i : data) {
+    i = distribution(generator);
+  }
+  return data;
+}
+
+/** what the simple search on a string did before */
+size_t find_sync_stream_reference(std::vector<uint8_t> const &data) {
+  static auto const magic_packet_size = size_t{102};
+  // NOLINTNEXTLINE
+  std::vector<uint8_t> const sync(6, 0xff);
+  auto const found = std::ranges::search(data, sync);
+  auto const pos =
+      static_cast<size_t>(std::distance(std::begin(data), found.begin()));
+  if (found.empty() || data.size() - pos < magic_packet_size) {
+    return data.size();
+  }
+  return pos;
+}
+} // namespace
+
+class Magic_packet_scanner_test : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(Magic_packet_scanner_test);
+  CPPUNIT_TEST(test_find_sync_stream);
+  CPPUNIT_TEST(test_find_sync_stream_random);
+  CPPUNIT_TEST(test_magic_packet_mac);
+  CPPUNIT_TEST(test_scanner);
+  CPPUNIT_TEST(test_scanner_long_sync_stream);
+  CPPUNIT_TEST_SUITE_END();
+
+  ether_addr const mac0 = mac_to_binary("01:45:12:78:af:bd");
+  ether_addr const mac1 = mac_to_binary("33:12:ab:de:56:81");
+  ether_addr const mac2 = mac_to_binary("ff:ff:ff:ff:ff:fe");
+
+public:
+  void test_find_sync_stream() {
+    auto const payload = create_wol_payload(mac0);
+    // place the sync stream at every offset of the vector loops and their
+    // scalar tails
+    // NOLINTNEXTLINE
+    for (size_t before = 0; before < 70; before++) {
+      // NOLINTNEXTLINE
+      auto data = std::vector<uint8_t>(before, 0x11) + payload;
+      for (auto const level : levels) {
+        CPPUNIT_ASSERT_EQUAL(before, find_sync_stream(data, 0, level));
+        CPPUNIT_ASSERT_EQUAL(data.size(),
+                             find_sync_stream(data, before + 1, level));
+      }
+      // too short to hold the macs
+      data.pop_back();
+      for (auto const level : levels) {
+        CPPUNIT_ASSERT_EQUAL(data.size(), find_sync_stream(data, 0, level));
+      }
+    }
+    for (auto const level : levels) {
+      CPPUNIT_ASSERT_EQUAL(size_t{0},
+                           find_sync_stream(std::vector<uint8_t>{}, 0, level));
+    }
+  }
+
+  void test_find_sync_stream_random() {
+    std::default_random_engine generator;
+    // NOLINTNEXTLINE
+    for (size_t size = 0; size < 400; size += 7) {
+      auto data = gen_random_data(size, generator);
+      // make 0xff frequent enough to get runs of them
+      for (auto &byte : data) {
+        // NOLINTNEXTLINE
+        if (byte > 0x60) {
+          byte = 0xff;
+        }
+      }
+      auto const expected = find_sync_stream_reference(data);
+      for (auto const level : levels) {
+        CPPUNIT_ASSERT_EQUAL(expected, find_sync_stream(data, 0, level));
+      }
+    }
+  }
+
+  void test_magic_packet_mac() {
+    // NOLINTNEXTLINE
+    std::vector<uint8_t> const data = std::vector<uint8_t>(3, 0x55) +
+                                      create_wol_payload(mac1) +
+                                      std::vector<uint8_t>(3, 0x55);
+    auto const mac = magic_packet_mac(data, 3);
+    CPPUNIT_ASSERT(mac.has_value());
+    CPPUNIT_ASSERT(binary_to_mac(mac1) == binary_to_mac(*mac));
+    CPPUNIT_ASSERT(!magic_packet_mac(data, 2).has_value());
+    CPPUNIT_ASSERT(!magic_packet_mac(data, 4).has_value());
+    CPPUNIT_ASSERT(!magic_packet_mac(data, data.size()).has_value());
+    // NOLINTNEXTLINE
+    CPPUNIT_ASSERT(!magic_packet_mac(data, 1000).has_value());
+
+    // one of the repetitions differs
+    auto broken = data;
+    // NOLINTNEXTLINE
+    broken.at(3 + 6 + 6 * 10 + 2) ^= 0x01U;
+    CPPUNIT_ASSERT(!magic_packet_mac(broken, 3).has_value());
+  }
+
+  void test_scanner() {
+    std::default_random_engine generator;
+    for (auto const level : levels) {
+      Magic_packet_scanner const scanner{{mac0, mac1, mac2}, level};
+      // NOLINTNEXTLINE
+      auto const noise = gen_random_data(80, generator);
+      CPPUNIT_ASSERT(!scanner(noise).has_value());
+      CPPUNIT_ASSERT(!scanner(create_wol_payload(
+                                  mac_to_binary("00:00:00:00:00:01")))
+                          .has_value());
+
+      auto const for_mac1 =
+          std::vector<uint8_t>{noise} + create_wol_payload(mac1) + noise;
+      CPPUNIT_ASSERT(scanner(for_mac1) == std::optional<size_t>{1});
+
+      // the unknown magic packet in front does not hide the known one
+      auto const second =
+          create_wol_payload(mac_to_binary("00:00:00:00:00:01")) + noise +
+          create_wol_payload(mac0);
+      CPPUNIT_ASSERT(scanner(second) == std::optional<size_t>{0});
+
+      // a truncated magic packet is no magic packet
+      auto truncated = create_wol_payload(mac0);
+      truncated.pop_back();
+      CPPUNIT_ASSERT(!scanner(truncated).has_value());
+
+      Magic_packet_scanner const empty{{}, level};
+      CPPUNIT_ASSERT(!empty(for_mac1).has_value());
+    }
+  }
+
+  void test_scanner_long_sync_stream() {
+    for (auto const level : levels) {
+      Magic_packet_scanner const scanner{{mac0, mac2}, level};
+      // more than six 0xff in front of the macs
+      // NOLINTNEXTLINE
+      auto const data =
+          std::vector<uint8_t>(9, 0xff) + create_wol_payload(mac0);
+      CPPUNIT_ASSERT(scanner(data) == std::optional<size_t>{0});
+
+      // the mac starts with 0xff as well and continues the sync stream
+      CPPUNIT_ASSERT(scanner(create_wol_payload(mac2)) ==
+                     std::optional<size_t>{1});
+    }
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(Magic_packet_scanner_test);
@@ -0,0 +1,157 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "netlink.h"
+
+#include "ethernet.h"
+#include "ip_address.h"
+#include "packet_test_utils.h"
+
+#include <cppunit/extensions/HelperMacros.h>
+#include <cstring>
+#include <linux/neighbour.h>
+#include <linux/rtnetlink.h>
+
+namespace {
+/** appends the bytes of value to buffer */
+template <typename T>
+void append(std::vector<uint8_t> &buffer, T const &value) {
+  std::vector<uint8_t> bytes(sizeof(T));
+  std::memcpy(bytes.data(), &value, sizeof(T));
+  buffer.insert(std::end(buffer), std::begin(bytes), std::end(bytes));
+}
+
+void append_attribute(std::vector<uint8_t> &buffer, uint16_t const type,
+                      std::vector<uint8_t> const &data) {
+  append(buffer,
+         rtattr{.rta_len = static_cast<uint16_t>(RTA_LENGTH(data.size())),
+                .rta_type = type});
+  buffer.insert(std::end(buffer), std::begin(data), std::end(data));
+  buffer.resize(RTA_ALIGN(buffer.size()));
+}
+
+/** RTM_NEWNEIGH payload of a neighbor with state and the given attributes */
+std::vector<uint8_t> create_new_neighbor(uint8_t const family,
+                                         uint16_t const state,
+                                         std::vector<uint8_t> const &ip,
+                                         std::vector<uint8_t> const &mac) {
+  std::vector<uint8_t> payload;
+  append(payload, ndmsg{.ndm_family = family,
+                        .ndm_pad1 = 0,
+                        .ndm_pad2 = 0,
+                        .ndm_ifindex = 3,
+                        .ndm_state = state,
+                        .ndm_flags = 0,
+                        .ndm_type = 0});
+  if (!ip.empty()) {
+    append_attribute(payload, NDA_DST, ip);
+  }
+  if (!mac.empty()) {
+    append_attribute(payload, NDA_LLADDR, mac);
+  }
+  return payload;
+}
+} // namespace
+
+class Netlink_test : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(Netlink_test);
+  CPPUNIT_TEST(test_get_link);
+  CPPUNIT_TEST(test_get_unknown_link);
+  CPPUNIT_TEST(test_change_addresses);
+  CPPUNIT_TEST(test_change_no_addresses);
+  CPPUNIT_TEST(test_parse_new_neighbor);
+  CPPUNIT_TEST(test_receive_no_neighbors);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  static void test_get_link() {
+    Netlink_socket netlink;
+    auto const link = netlink.get_link("lo");
+    CPPUNIT_ASSERT(link.index > 0);
+    CPPUNIT_ASSERT((link.flags & IFF_LOOPBACK) != 0);
+    CPPUNIT_ASSERT_EQUAL(std::string("0:0:0:0:0:0"),
+                         binary_to_mac(link.address));
+    // the socket can be used for more than one request
+    CPPUNIT_ASSERT_EQUAL(link.index, netlink.get_link("lo").index);
+  }
+
+  static void test_get_unknown_link() {
+    Netlink_socket netlink;
+    CPPUNIT_ASSERT_THROW(static_cast<void>(netlink.get_link("doesnotexist0")),
+                         std::runtime_error);
+  }
+
+  static void test_change_addresses() {
+    std::vector<IP_address> const ips{parse_ip("127.1.2.3/8"),
+                                      parse_ip("127.1.2.4/8"),
+                                      parse_ip("fd12:3456:789a::1/128")};
+    Netlink_socket netlink;
+    auto const lo = netlink.get_link("lo").index;
+    netlink.change_addresses(Action::add, lo, ips);
+    // the addresses are present, adding them again fails
+    CPPUNIT_ASSERT_THROW(netlink.change_addresses(Action::add, lo, ips),
+                         std::runtime_error);
+    netlink.change_addresses(Action::del, lo, ips);
+    CPPUNIT_ASSERT_THROW(netlink.change_addresses(Action::del, lo, ips),
+                         std::runtime_error);
+  }
+
+  static void test_change_no_addresses() {
+    Netlink_socket netlink;
+    netlink.change_addresses(Action::add, netlink.get_link("lo").index, {});
+  }
+
+  static void test_parse_new_neighbor() {
+    auto const mac = to_binary("020000000002");
+    auto const ipv4 = parse_new_neighbor(create_new_neighbor(
+        AF_INET, NUD_REACHABLE, to_binary("c0a80101"), mac));
+    CPPUNIT_ASSERT(ipv4.has_value());
+    CPPUNIT_ASSERT_EQUAL(3, ipv4->index);
+    CPPUNIT_ASSERT_EQUAL(parse_ip("192.168.1.1").host(), ipv4->ip);
+    CPPUNIT_ASSERT_EQUAL(std::string("2:0:0:0:0:2"),
+                         binary_to_mac(ipv4->address));
+
+    auto const ipv6 = parse_new_neighbor(create_new_neighbor(
+        AF_INET6, NUD_STALE, to_binary("fd000000000000000000000000001234"),
+        mac));
+    CPPUNIT_ASSERT(ipv6.has_value());
+    CPPUNIT_ASSERT_EQUAL(parse_ip("fd00::1234").host(), ipv6->ip);
+
+    // unresolved neighbors and ones without address are skipped
+    CPPUNIT_ASSERT(!parse_new_neighbor(
+                        create_new_neighbor(AF_INET, NUD_FAILED,
+                                            to_binary("c0a80101"), mac))
+                        .has_value());
+    CPPUNIT_ASSERT(!parse_new_neighbor(create_new_neighbor(
+                                           AF_INET, NUD_REACHABLE,
+                                           to_binary("c0a80101"), {}))
+                        .has_value());
+    CPPUNIT_ASSERT(!parse_new_neighbor(
+                        create_new_neighbor(AF_INET, NUD_REACHABLE, {}, mac))
+                        .has_value());
+    CPPUNIT_ASSERT_THROW((void)parse_new_neighbor({}), std::length_error);
+  }
+
+  static void test_receive_no_neighbors() {
+    // does not block if nothing has been queued
+    Netlink_socket netlink{RTMGRP_NEIGH};
+    for (auto const &neighbor : netlink.receive_neighbors()) {
+      CPPUNIT_ASSERT(neighbor.index > 0);
+    }
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(Netlink_test);
@@ -0,0 +1,117 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "packet_parser.h"
+
+#include "packet_test_utils.h"
+
+#include <atomic>
+#include <cppunit/extensions/HelperMacros.h>
+#include <cstdlib>
+#include <new>
+
+// replaces the global allocation functions of this test program to count
+// heap allocations
+namespace {
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+std::atomic<size_t> allocations{0};
+} // namespace
+
+void *operator new(size_t const size) {
+  allocations++;
+  // NOLINTNEXTLINE(cppcoreguidelines-no-malloc)
+  void *const ptr = std::malloc(size == 0 ? 1 : size);
+  if (ptr == nullptr) {
+    throw std::bad_alloc();
+  }
+  return ptr;
+}
+
+// NOLINTNEXTLINE(cppcoreguidelines-no-malloc)
+void operator delete(void *const ptr) noexcept { std::free(ptr); }
+
+// NOLINTNEXTLINE(cppcoreguidelines-no-malloc)
+void operator delete(void *const ptr, size_t) noexcept { std::free(ptr); }
+
+namespace {
+// ethernet, 127.0.0.1 -> 127.0.0.1, TCP SYN from port 50000 to port 22
+const std::string ethernet_ipv4_syn_wireshark =
+    "00000000000000000000000008004500003c88d040004006b3e97f0000017f000001"
+    "c35000160000000000000000a002ffd70000000002040050";
+
+// linux cooked capture, ::1 -> ::1, TCP SYN from port 50000 to port 22
+const std::string lcc_ipv6_syn_wireshark =
+    "000000010006000000000000000086dd600000000014064000000000000000000000000000"
+    "00000100000000000000000000000000000001c35000160000000000000000a002ffd7000"
+    "00000";
+
+// linux cooked capture with VLAN, 192.168.1.155 -> 79.143.179.211 TCP
+const std::string lcc_vlan_ipv4_syn_wireshark =
+    "000000010006e8de2755a17100008100000108004500009000004000400674b7c0a8019b"
+    "4f8fb3d3c35000160000000000000000a002ffd70000000002040050";
+
+/** allocations done by get_headers() and get_destination_port() */
+size_t count_allocations(int const datalink, std::vector<uint8_t> const &data) {
+  auto const before = allocations.load();
+  auto const headers = get_headers(datalink, data);
+  auto const port = get_destination_port(headers, data);
+  auto const after = allocations.load();
+  CPPUNIT_ASSERT(std::get<1>(headers).has_value());
+  CPPUNIT_ASSERT(port.has_value());
+  CPPUNIT_ASSERT_EQUAL(uint16_t{22}, *port);
+  return after - before;
+}
+} // namespace
+
+class Packet_parser_allocation_test : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(Packet_parser_allocation_test);
+  CPPUNIT_TEST(test_allocations_are_counted);
+  CPPUNIT_TEST(test_get_headers_ethernet_ipv4);
+  CPPUNIT_TEST(test_get_headers_lcc_ipv6);
+  CPPUNIT_TEST(test_get_headers_lcc_vlan_ipv4);
+  CPPUNIT_TEST_SUITE_END();
+
+  const std::vector<uint8_t> ethernet_ipv4_syn =
+      to_binary(ethernet_ipv4_syn_wireshark);
+  const std::vector<uint8_t> lcc_ipv6_syn = to_binary(lcc_ipv6_syn_wireshark);
+  const std::vector<uint8_t> lcc_vlan_ipv4_syn =
+      to_binary(lcc_vlan_ipv4_syn_wireshark);
+
+public:
+  static void test_allocations_are_counted() {
+    auto const before = allocations.load();
+    auto const ptr = std::make_unique<int>(1);
+    auto const after = allocations.load();
+    CPPUNIT_ASSERT_EQUAL(size_t{1}, after - before);
+  }
+
+  void test_get_headers_ethernet_ipv4() {
+    CPPUNIT_ASSERT_EQUAL(size_t{0},
+                         count_allocations(DLT_EN10MB, ethernet_ipv4_syn));
+  }
+
+  void test_get_headers_lcc_ipv6() {
+    CPPUNIT_ASSERT_EQUAL(size_t{0},
+                         count_allocations(DLT_LINUX_SLL, lcc_ipv6_syn));
+  }
+
+  void test_get_headers_lcc_vlan_ipv4() {
+    CPPUNIT_ASSERT_EQUAL(size_t{0},
+                         count_allocations(DLT_LINUX_SLL, lcc_vlan_ipv4_syn));
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(Packet_parser_allocation_test);
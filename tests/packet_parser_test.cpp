@@ -45,6 +45,10 @@ const std::string lcc_vlan_ipv4_udp_wireshark = "000000010006e8de2755a171000081"
                                                 "000001080045000090000040004011"
                                                 "74b7c0a8019b4f8fb3d3";
 
+const std::string lcc2_ipv4_udp_wireshark =
+    "080000000000000100010006e8de2755a17100004500003e057f40004011372e7f000001"
+    "7f000001";
+
 class Packet_parser_test : public CppUnit::TestFixture {
   CPPUNIT_TEST_SUITE(Packet_parser_test);
   CPPUNIT_TEST(test_parse_ethernet_ipv4_tcp);
@@ -57,12 +61,19 @@ class Packet_parser_test : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_parse_lcc_ipv6_tcp_too_short);
   CPPUNIT_TEST(test_parse_lcc_vlan_ipv4_udp);
   CPPUNIT_TEST(test_parse_lcc_vlan_ipv4_udp_too_short);
+  CPPUNIT_TEST(test_parse_lcc2_ipv4_udp);
+  CPPUNIT_TEST(test_parse_lcc2_ipv4_udp_too_short);
   CPPUNIT_TEST(test_parse_unknown_link_layer);
   CPPUNIT_TEST(test_parse_unknown_ip);
   CPPUNIT_TEST(test_catch_incoming_connection);
   CPPUNIT_TEST(test_catch_incoming_connection_unknown_lcc_protocol);
   CPPUNIT_TEST(test_catch_incoming_connection_void_ptr);
+  CPPUNIT_TEST(test_catch_incoming_connection_no_ip);
+  CPPUNIT_TEST(test_to_packet_view);
   CPPUNIT_TEST(test_stream_operator);
+  CPPUNIT_TEST(test_header_parser);
+  CPPUNIT_TEST(test_header_parser_too_short);
+  CPPUNIT_TEST(test_with_header_parser);
   CPPUNIT_TEST_SUITE_END();
 
   const std::vector<uint8_t> ethernet_ipv4_tcp =
@@ -75,6 +86,7 @@ class Packet_parser_test : public CppUnit::TestFixture {
   const std::vector<uint8_t> lcc_ipv6_tcp = to_binary(lcc_ipv6_tcp_wireshark);
   const std::vector<uint8_t> lcc_vlan_ipv4_udp =
       to_binary(lcc_vlan_ipv4_udp_wireshark);
+  const std::vector<uint8_t> lcc2_ipv4_udp = to_binary(lcc2_ipv4_udp_wireshark);
 
 public:
   void test_parse_ethernet_ipv4_tcp() {
@@ -165,11 +177,28 @@ public:
         std::length_error);
   }
 
+  void test_parse_lcc2_ipv4_udp() {
+    auto headers = get_headers(DLT_LINUX_SLL2, lcc2_ipv4_udp);
+    auto &ll = std::get<0>(headers);
+    test_ll(ll, Link_layer::lcc2_header_size, "e8:de:27:55:a1:71",
+            Payload_protocol::ipv4,
+            "Linux cooked capture: src: e8:de:27:55:a1:71");
+    test_ip(std::get<1>(headers), ip::ipv4, "127.0.0.1/32", "127.0.0.1/32",
+            ip::ipv4_header_size, ip::UDP);
+  }
+
+  void test_parse_lcc2_ipv4_udp_too_short() {
+    std::vector<uint8_t> lcc2_ipv4_udp_short(std::begin(lcc2_ipv4_udp),
+                                             std::end(lcc2_ipv4_udp) - 1);
+    CPPUNIT_ASSERT_THROW((void)get_headers(DLT_LINUX_SLL2, lcc2_ipv4_udp_short),
+                         std::length_error);
+  }
+
   static void test_parse_unknown_link_layer() {
     std::vector<uint8_t> const data;
     auto const headers = get_headers(-1, data);
-    CPPUNIT_ASSERT(nullptr == std::get<0>(headers));
-    CPPUNIT_ASSERT(nullptr == std::get<1>(headers));
+    CPPUNIT_ASSERT(!std::get<0>(headers).has_value());
+    CPPUNIT_ASSERT(!std::get<1>(headers).has_value());
   }
 
   void test_parse_unknown_ip() {
@@ -180,8 +209,8 @@ public:
     data.at(first_payload_type_byte) = std::numeric_limits<uint8_t>::max();
     data.at(second_payload_type_byte) = std::numeric_limits<uint8_t>::max();
     auto const headers = get_headers(DLT_EN10MB, data);
-    CPPUNIT_ASSERT(nullptr != std::get<0>(headers));
-    CPPUNIT_ASSERT(nullptr == std::get<1>(headers));
+    CPPUNIT_ASSERT(std::get<0>(headers).has_value());
+    CPPUNIT_ASSERT(!std::get<1>(headers).has_value());
 
     auto const &ll = std::get<0>(headers);
     CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(14), ll->header_length());
@@ -229,6 +258,34 @@ public:
     CPPUNIT_ASSERT_EQUAL(basic_headers(), cic.headers);
   }
 
+  void test_catch_incoming_connection_no_ip() {
+    std::vector<uint8_t> data{std::begin(ethernet_ipv4_tcp),
+                              std::end(ethernet_ipv4_tcp)};
+    static auto const first_payload_type_byte = uint8_t{12};
+    data.at(first_payload_type_byte) = std::numeric_limits<uint8_t>::max();
+    Catch_incoming_connection cic(DLT_EN10MB);
+    pcap_pkthdr hdr{};
+    hdr.len = static_cast<bpf_u_int32>(data.size());
+    cic(&hdr, data.data());
+    // nothing to replay, nothing is kept
+    CPPUNIT_ASSERT(std::get<0>(cic.headers).has_value());
+    CPPUNIT_ASSERT(!std::get<1>(cic.headers).has_value());
+    CPPUNIT_ASSERT_EQUAL(static_cast<size_t>(0), cic.data.size());
+  }
+
+  void test_to_packet_view() {
+    pcap_pkthdr hdr{};
+    hdr.len = static_cast<bpf_u_int32>(ethernet_ipv4_tcp.size());
+    auto const view = to_packet_view(hdr, ethernet_ipv4_tcp.data());
+    CPPUNIT_ASSERT(ethernet_ipv4_tcp.data() == view.data());
+    CPPUNIT_ASSERT_EQUAL(ethernet_ipv4_tcp.size(), view.size());
+
+    auto const headers = get_headers(DLT_EN10MB, view);
+    auto const from_vector = get_headers(DLT_EN10MB, ethernet_ipv4_tcp);
+    CPPUNIT_ASSERT_EQUAL(*std::get<0>(from_vector), *std::get<0>(headers));
+    CPPUNIT_ASSERT_EQUAL(*std::get<1>(from_vector), *std::get<1>(headers));
+  }
+
   void test_stream_operator() {
     auto headers = get_headers(DLT_EN10MB, ethernet_ipv4_tcp);
     std::stringstream ss;
@@ -238,27 +295,72 @@ public:
                     "= 127.0.0.1, src = 127.0.0.1"),
         ss.str());
 
-    basic_headers const headers1 = std::make_tuple(
-        std::unique_ptr<Link_layer>(), std::move(std::get<1>(headers)));
+    basic_headers const headers1{std::nullopt, std::get<1>(headers)};
     ss.str("");
     ss << headers1;
     CPPUNIT_ASSERT_EQUAL(
         std::string("\nIPv4: dst = 127.0.0.1, src = 127.0.0.1"), ss.str());
 
-    basic_headers const headers2 =
-        std::make_tuple(std::move(std::get<0>(headers)), std::unique_ptr<ip>());
+    basic_headers const headers2{std::get<0>(headers), std::nullopt};
     ss.str("");
     ss << headers2;
     CPPUNIT_ASSERT_EQUAL(
         std::string("Ethernet: dst = 0:0:0:0:0:0, src = 0:0:0:0:0:0\n"),
         ss.str());
 
-    basic_headers const headers3 =
-        std::make_tuple(std::unique_ptr<Link_layer>(), std::unique_ptr<ip>());
+    basic_headers const headers3{std::nullopt, std::nullopt};
     ss.str("");
     ss << headers3;
     CPPUNIT_ASSERT_EQUAL(std::string("\n"), ss.str());
   }
+
+  void test_header_parser() {
+    CPPUNIT_ASSERT_EQUAL(get_headers(DLT_EN10MB, ethernet_ipv4_tcp),
+                         Header_parser<DLT_EN10MB>{}(ethernet_ipv4_tcp));
+    CPPUNIT_ASSERT_EQUAL(get_headers(DLT_EN10MB, ethernet_ipv6_tcp),
+                         Header_parser<DLT_EN10MB>{}(ethernet_ipv6_tcp));
+    CPPUNIT_ASSERT_EQUAL(get_headers(DLT_LINUX_SLL, lcc_ipv4_udp),
+                         Header_parser<DLT_LINUX_SLL>{}(lcc_ipv4_udp));
+    CPPUNIT_ASSERT_EQUAL(get_headers(DLT_LINUX_SLL, lcc_ipv6_tcp),
+                         Header_parser<DLT_LINUX_SLL>{}(lcc_ipv6_tcp));
+    CPPUNIT_ASSERT_EQUAL(get_headers(DLT_LINUX_SLL, lcc_vlan_ipv4_udp),
+                         Header_parser<DLT_LINUX_SLL>{}(lcc_vlan_ipv4_udp));
+    CPPUNIT_ASSERT_EQUAL(get_headers(DLT_LINUX_SLL2, lcc2_ipv4_udp),
+                         Header_parser<DLT_LINUX_SLL2>{}(lcc2_ipv4_udp));
+  }
+
+  void test_header_parser_too_short() {
+    std::vector<uint8_t> const ethernet_ipv4_tcp_short(
+        std::begin(ethernet_ipv4_tcp), std::end(ethernet_ipv4_tcp) - 1);
+    CPPUNIT_ASSERT_THROW(
+        (void)Header_parser<DLT_EN10MB>{}(ethernet_ipv4_tcp_short),
+        std::length_error);
+    std::vector<uint8_t> const lcc_ipv4_udp_short(std::begin(lcc_ipv4_udp),
+                                                  std::begin(lcc_ipv4_udp) + 8);
+    CPPUNIT_ASSERT_THROW(
+        (void)Header_parser<DLT_LINUX_SLL>{}(lcc_ipv4_udp_short),
+        std::length_error);
+  }
+
+  void test_with_header_parser() {
+    auto const datalink_of = [](auto const parser) { return parser.datalink; };
+    CPPUNIT_ASSERT_EQUAL(DLT_EN10MB,
+                         with_header_parser(DLT_EN10MB, datalink_of));
+    CPPUNIT_ASSERT_EQUAL(DLT_LINUX_SLL,
+                         with_header_parser(DLT_LINUX_SLL, datalink_of));
+    CPPUNIT_ASSERT_EQUAL(DLT_LINUX_SLL2,
+                         with_header_parser(DLT_LINUX_SLL2, datalink_of));
+    CPPUNIT_ASSERT_EQUAL(DLT_RAW, with_header_parser(DLT_RAW, datalink_of));
+
+    // whatever is picked, it parses like get_headers()
+    auto const parse = [&](int const datalink, auto const &packet) {
+      return with_header_parser(
+          datalink, [&](auto const parser) { return parser(packet); });
+    };
+    CPPUNIT_ASSERT_EQUAL(get_headers(DLT_LINUX_SLL, lcc_vlan_ipv4_udp),
+                         parse(DLT_LINUX_SLL, lcc_vlan_ipv4_udp));
+    CPPUNIT_ASSERT_EQUAL(basic_headers(), parse(-1, ethernet_ipv4_tcp));
+  }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(Packet_parser_test);
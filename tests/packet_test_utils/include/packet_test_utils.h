@@ -23,6 +23,7 @@
 #include <ip.h>
 #include <ip_address.h>
 #include <memory>
+#include <optional>
 #include <pcap_wrapper.h>
 #include <spawn_process.h>
 #include <to_string.h>
@@ -37,11 +38,11 @@ enum class Payload_protocol : std::uint16_t {
   vlan = ETHERTYPE_VLAN
 };
 
-void test_ll(const std::unique_ptr<Link_layer> &ll, size_t length,
+void test_ll(const std::optional<Link_layer> &ll, size_t length,
              const std::string &src, Payload_protocol payload_protocol,
              const std::string &info);
 
-void test_ip(const std::unique_ptr<ip> &ip, ip::Version v,
+void test_ip(const std::optional<ip> &ip, ip::Version v,
              const std::string &src, const std::string &dst,
              size_t header_length, ip::Payload pl_type);
 
@@ -49,8 +50,6 @@ bool operator==(const Link_layer &lhs, const Link_layer &rhs);
 
 bool operator==(const ip &lhs, const ip &rhs);
 
-bool operator<(IP_address const &lhs, IP_address const &rhs);
-
 std::vector<std::string> get_ip_neigh_output();
 
 using Iface_Ips = std::vector<std::tuple<std::string, IP_address>>;
@@ -125,10 +124,9 @@ struct Pcap_dummy : public Pcap_wrapper {
 
   void set_loop_return(Pcap_wrapper::Loop_end_reason const &ler);
 
-  Pcap_wrapper::Loop_end_reason
-  loop(int count,
-       std::function<void(const struct pcap_pkthdr *, const u_char *)> cb)
-      override;
+protected:
+  Pcap_wrapper::Loop_end_reason run_loop(int count, pcap_handler callback,
+                                         u_char *user) override;
 };
 
 std::string get_executable_path();
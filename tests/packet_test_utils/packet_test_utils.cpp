@@ -57,10 +57,10 @@ std::vector<uint8_t> to_binary(const std::string &hex) {
   return binary;
 }
 
-void test_ip(const std::unique_ptr<ip> &ip, const ip::Version v,
+void test_ip(const std::optional<ip> &ip, const ip::Version v,
              const std::string &src, const std::string &dst,
              const size_t header_length, const ip::Payload pl_type) {
-  CPPUNIT_ASSERT(ip != nullptr);
+  CPPUNIT_ASSERT(ip.has_value());
   CPPUNIT_ASSERT_EQUAL(v, ip->version());
   CPPUNIT_ASSERT_EQUAL(parse_ip(src), ip->source());
   CPPUNIT_ASSERT_EQUAL(parse_ip(dst), ip->destination());
@@ -68,10 +68,10 @@ void test_ip(const std::unique_ptr<ip> &ip, const ip::Version v,
   CPPUNIT_ASSERT_EQUAL(header_length, ip->header_length());
 }
 
-void test_ll(const std::unique_ptr<Link_layer> &ll, const size_t length,
+void test_ll(const std::optional<Link_layer> &ll, const size_t length,
              const std::string &src, const Payload_protocol payload_protocol,
              const std::string &info) {
-  CPPUNIT_ASSERT(ll != nullptr);
+  CPPUNIT_ASSERT(ll.has_value());
   CPPUNIT_ASSERT_EQUAL(length, ll->header_length());
   CPPUNIT_ASSERT_EQUAL(src, binary_to_mac(ll->source()));
   CPPUNIT_ASSERT_EQUAL(static_cast<uint16_t>(payload_protocol),
@@ -92,10 +92,6 @@ bool operator==(const ip &lhs, const ip &rhs) {
          lhs.source() == rhs.source();
 }
 
-bool operator<(IP_address const &lhs, IP_address const &rhs) {
-  return lhs.with_subnet() < rhs.with_subnet();
-}
-
 std::vector<std::string> get_ip_neigh_output() {
   auto const out_in = get_self_pipes(false);
   std::vector<std::string> const cmd{"ip", "neigh"};
@@ -188,9 +184,9 @@ void Pcap_dummy::set_loop_return(Pcap_wrapper::Loop_end_reason const &ler) {
   loop_return = ler;
 }
 
-Pcap_wrapper::Loop_end_reason Pcap_dummy::loop(
-    const int /*count*/,
-    std::function<void(const struct pcap_pkthdr *, const u_char *)> /*cb*/) {
+Pcap_wrapper::Loop_end_reason Pcap_dummy::run_loop(const int /*count*/,
+                                                   pcap_handler /*callback*/,
+                                                   u_char * /*user*/) {
   return loop_return;
 }
 
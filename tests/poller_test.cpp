@@ -0,0 +1,162 @@
+// Copyright (C) 2026  Lutz Reinhardt
+//
+// This program is free software; you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation; either version 2 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+
+#include "poller.h"
+
+#include "file_descriptor.h"
+
+#include <chrono>
+#include <csignal>
+#include <cppunit/extensions/HelperMacros.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+// NOLINTNEXTLINE(cppcoreguidelines-avoid-non-const-global-variables)
+Poller *signal_poller = nullptr;
+
+void wake_on_signal(int /*unused*/) { signal_poller->wake(); }
+
+void write_byte(int const fd) {
+  char const byte = 'x';
+  CPPUNIT_ASSERT_EQUAL(ssize_t{1}, write(fd, &byte, 1));
+}
+
+void read_byte(int const fd) {
+  char byte = 0;
+  CPPUNIT_ASSERT_EQUAL(ssize_t{1}, read(fd, &byte, 1));
+}
+} // namespace
+
+class Poller_test : public CppUnit::TestFixture {
+  CPPUNIT_TEST_SUITE(Poller_test);
+  CPPUNIT_TEST(test_poll_calls_handler);
+  CPPUNIT_TEST(test_poll_timeout);
+  CPPUNIT_TEST(test_several_file_descriptors);
+  CPPUNIT_TEST(test_remove);
+  CPPUNIT_TEST(test_wake_before_poll);
+  CPPUNIT_TEST(test_wake_from_other_thread);
+  CPPUNIT_TEST(test_wake_from_signal_handler);
+  CPPUNIT_TEST_SUITE_END();
+
+public:
+  static void test_poll_calls_handler() {
+    Poller poller;
+    auto const [read_end, write_end] = get_self_pipes();
+    int called = 0;
+    poller.add(read_end, [&] {
+      read_byte(read_end);
+      called++;
+    });
+    write_byte(write_end);
+    CPPUNIT_ASSERT(poller.poll());
+    CPPUNIT_ASSERT_EQUAL(1, called);
+  }
+
+  static void test_poll_timeout() {
+    Poller poller;
+    auto const [read_end, write_end] = get_self_pipes();
+    int called = 0;
+    poller.add(read_end, [&] { called++; });
+    CPPUNIT_ASSERT(poller.poll(1));
+    CPPUNIT_ASSERT_EQUAL(0, called);
+  }
+
+  static void test_several_file_descriptors() {
+    Poller poller;
+    auto const [read_end0, write_end0] = get_self_pipes();
+    auto const [read_end1, write_end1] = get_self_pipes();
+    int called0 = 0;
+    int called1 = 0;
+    poller.add(read_end0, [&] {
+      read_byte(read_end0);
+      called0++;
+    });
+    poller.add(read_end1, [&] {
+      read_byte(read_end1);
+      called1++;
+    });
+    write_byte(write_end1);
+    CPPUNIT_ASSERT(poller.poll());
+    CPPUNIT_ASSERT_EQUAL(0, called0);
+    CPPUNIT_ASSERT_EQUAL(1, called1);
+
+    write_byte(write_end0);
+    write_byte(write_end1);
+    CPPUNIT_ASSERT(poller.poll());
+    CPPUNIT_ASSERT_EQUAL(1, called0);
+    CPPUNIT_ASSERT_EQUAL(2, called1);
+  }
+
+  static void test_remove() {
+    Poller poller;
+    auto const [read_end, write_end] = get_self_pipes();
+    int called = 0;
+    poller.add(read_end, [&] { called++; });
+    poller.remove(read_end);
+    write_byte(write_end);
+    CPPUNIT_ASSERT(poller.poll(1));
+    CPPUNIT_ASSERT_EQUAL(0, called);
+
+    // can be added again
+    poller.add(read_end, [&] { called++; });
+    CPPUNIT_ASSERT(poller.poll(1));
+    CPPUNIT_ASSERT_EQUAL(1, called);
+
+    CPPUNIT_ASSERT_THROW(poller.add(read_end, [] {}), std::runtime_error);
+  }
+
+  static void test_wake_before_poll() {
+    Poller poller;
+    auto const [read_end, write_end] = get_self_pipes();
+    int called = 0;
+    poller.add(read_end, [&] { called++; });
+    write_byte(write_end);
+    poller.wake();
+    CPPUNIT_ASSERT(!poller.poll());
+    CPPUNIT_ASSERT_EQUAL(0, called);
+
+    // the wake has been consumed
+    CPPUNIT_ASSERT(poller.poll(1));
+    CPPUNIT_ASSERT_EQUAL(1, called);
+  }
+
+  static void test_wake_from_other_thread() {
+    Poller poller;
+    std::thread waker{[&poller] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      poller.wake();
+    }};
+    CPPUNIT_ASSERT(!poller.poll());
+    waker.join();
+  }
+
+  static void test_wake_from_signal_handler() {
+    Poller poller;
+    signal_poller = &poller;
+    struct sigaction sa{};
+    // NOLINTNEXTLINE
+    sa.sa_handler = wake_on_signal;
+    struct sigaction old{};
+    CPPUNIT_ASSERT_EQUAL(0, sigaction(SIGUSR1, &sa, &old));
+    CPPUNIT_ASSERT_EQUAL(0, raise(SIGUSR1));
+    CPPUNIT_ASSERT(!poller.poll());
+    CPPUNIT_ASSERT_EQUAL(0, sigaction(SIGUSR1, &old, nullptr));
+    signal_poller = nullptr;
+  }
+};
+
+CPPUNIT_TEST_SUITE_REGISTRATION(Poller_test);
@@ -15,6 +15,7 @@
 // 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
 
 #include "file_descriptor.h"
+#include "netlink.h"
 #include "scope_guard.h"
 
 #include "to_string.h"
@@ -28,12 +29,18 @@ class Scope_guard_test : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_scope_guard_with_changed_variable);
   CPPUNIT_TEST(test_ptr_guard);
   CPPUNIT_TEST(test_temp_ip);
+  CPPUNIT_TEST(test_temp_ips);
   CPPUNIT_TEST(test_drop_port);
   CPPUNIT_TEST(test_reject_tp);
   CPPUNIT_TEST(test_block_icmp);
   CPPUNIT_TEST(test_block_ipv6_neighbor_solicitation_link_local);
   CPPUNIT_TEST(test_block_ipv6_neighbor_solicitation_global_address);
   CPPUNIT_TEST(test_block_ipv6_neighbor_solicitation_with_ipv4);
+  CPPUNIT_TEST(test_firewall_transaction_ruleset);
+  CPPUNIT_TEST(test_firewall_transaction_without_rules);
+  CPPUNIT_TEST(test_nft_transaction_ruleset);
+  CPPUNIT_TEST(test_nft_table);
+  CPPUNIT_TEST(test_firewall_backend);
   CPPUNIT_TEST(test_take_action);
   CPPUNIT_TEST(test_take_action_failed_command);
   CPPUNIT_TEST(test_take_action_non_existing_command);
@@ -167,6 +174,25 @@ public:
                          ti2(Action::del));
   }
 
+  static void test_temp_ips() {
+    std::vector<IP_address> const ips{parse_ip("127.3.2.1/8"),
+                                      parse_ip("fd12:3456:789a::2/128")};
+    Netlink_socket netlink;
+    auto const lo = netlink.get_link("lo").index;
+    {
+      Scope_guard const guard{Temp_ips{.iface = "lo", .ips = ips}};
+      // already added by the guard
+      CPPUNIT_ASSERT_THROW(netlink.change_addresses(Action::add, lo, ips),
+                           std::runtime_error);
+    }
+    // already removed by the guard
+    CPPUNIT_ASSERT_THROW(netlink.change_addresses(Action::del, lo, ips),
+                         std::runtime_error);
+    CPPUNIT_ASSERT_THROW(
+        (Scope_guard{Temp_ips{.iface = "doesnotexist0", .ips = ips}}),
+        std::runtime_error);
+  }
+
   static void test_drop_port() {
     IP_address ip = parse_ip("10.0.0.1/16");
     static const uint16_t port0{1234};
@@ -307,6 +333,112 @@ public:
     }
   };
 
+  static void test_firewall_transaction_ruleset() {
+    auto const ipv4 = parse_ip("10.0.0.1/16");
+    auto const ipv6 = parse_ip("fe80::123");
+    Firewall_transaction const firewall{
+        .rules = {Reject_tp{.ip = ipv4, .tcp_udp = Reject_tp::TP::TCP},
+                  Drop_port{.ip = ipv4, .port = 22},
+                  Reject_tp{.ip = ipv6, .tcp_udp = Reject_tp::TP::UDP},
+                  Block_icmp{ipv6}, Block_ipv6_neighbor_solicitation{ipv6}}};
+    CPPUNIT_ASSERT_EQUAL(
+        std::string("*filter\n"
+                    "-I INPUT -d 10.0.0.1 -p tcp -j REJECT\n"
+                    "-I INPUT -d 10.0.0.1 -p tcp --syn --dport 22 -j DROP\n"
+                    "COMMIT\n"),
+        firewall.ruleset(AF_INET, Action::add));
+    CPPUNIT_ASSERT_EQUAL(
+        std::string("*filter\n"
+                    "-D INPUT -d 10.0.0.1 -p tcp -j REJECT\n"
+                    "-D INPUT -d 10.0.0.1 -p tcp --syn --dport 22 -j DROP\n"
+                    "COMMIT\n"),
+        firewall.ruleset(AF_INET, Action::del));
+    CPPUNIT_ASSERT_EQUAL(
+        std::string("*filter\n"
+                    "-I INPUT -d fe80::123 -p udp -j REJECT\n"
+                    "-I OUTPUT -d fe80::123 -p icmpv6 --icmpv6-type "
+                    "destination-unreachable -j DROP\n"
+                    "-I INPUT -s :: -p icmpv6 --icmpv6-type "
+                    "neighbour-solicitation -m u32 --u32 48=0xfe800000&&"
+                    "52=0x00000000&&56=0x00000000&&60=0x00000123 -j DROP\n"
+                    "COMMIT\n"),
+        firewall.ruleset(AF_INET6, Action::add));
+
+    Firewall_transaction const only_ipv4{.rules = {Block_icmp{ipv4}}};
+    CPPUNIT_ASSERT_EQUAL(std::string(),
+                         only_ipv4.ruleset(AF_INET6, Action::add));
+  }
+
+  static void test_firewall_transaction_without_rules() {
+    Firewall_transaction const firewall{.rules = {}};
+    CPPUNIT_ASSERT_EQUAL(std::string(), firewall(Action::add));
+    CPPUNIT_ASSERT_EQUAL(std::string(), firewall(Action::del));
+  }
+
+  static void test_nft_transaction_ruleset() {
+    auto const ipv4 = parse_ip("10.0.0.1/16");
+    auto const ipv6 = parse_ip("fe80::123");
+    Nft_transaction const firewall{
+        .rules = {Reject_tp{.ip = ipv4, .tcp_udp = Reject_tp::TP::TCP},
+                  Drop_port{.ip = ipv4, .port = 22},
+                  Reject_tp{.ip = ipv6, .tcp_udp = Reject_tp::TP::UDP},
+                  Drop_port{.ip = ipv6, .port = 80}, Block_icmp{ipv4},
+                  Block_ipv6_neighbor_solicitation{ipv6}}};
+    CPPUNIT_ASSERT_EQUAL(
+        std::string(
+            "add element inet sleep_proxy reject_tcp4 { 10.0.0.1 }\n"
+            "add element inet sleep_proxy drop_syn4 { 10.0.0.1 . 22 }\n"
+            "add element inet sleep_proxy reject_udp6 { fe80::123 }\n"
+            "add element inet sleep_proxy drop_syn6 { fe80::123 . 80 }\n"
+            "add element inet sleep_proxy drop_unreachable4 { 10.0.0.1 }\n"
+            "add element inet sleep_proxy drop_solicitation { fe80::123 }\n"),
+        firewall.ruleset(Action::add));
+    CPPUNIT_ASSERT(firewall.ruleset(Action::del)
+                       .starts_with("delete element inet sleep_proxy "
+                                    "reject_tcp4 { 10.0.0.1 }\n"));
+
+    Nft_transaction const solicitation_ipv4{
+        .rules = {Block_ipv6_neighbor_solicitation{ipv4}}};
+    CPPUNIT_ASSERT_THROW((void)solicitation_ipv4.ruleset(Action::add),
+                         std::runtime_error);
+    CPPUNIT_ASSERT_EQUAL(std::string(),
+                         Nft_transaction{.rules = {}}.ruleset(Action::add));
+  }
+
+  static void test_nft_table() {
+    auto const table = get_nft_table();
+    // replaces what is left from an earlier run
+    CPPUNIT_ASSERT(table.starts_with("add table inet sleep_proxy\n"
+                                     "delete table inet sleep_proxy\n"
+                                     "table inet sleep_proxy {\n"));
+    // the sets used by Nft_transaction exist
+    for (auto const *const set :
+         {"drop_syn4", "drop_syn6", "reject_tcp4", "reject_tcp6",
+          "reject_udp4", "reject_udp6", "drop_unreachable4",
+          "drop_unreachable6", "drop_solicitation"}) {
+      CPPUNIT_ASSERT(table.find(std::string("set ") + set + " {") !=
+                     std::string::npos);
+      CPPUNIT_ASSERT(table.find(std::string("@") + set + " ") !=
+                     std::string::npos);
+    }
+  }
+
+  static void test_firewall_backend() {
+    CPPUNIT_ASSERT_EQUAL(Firewall_backend::iptables,
+                         parse_firewall_backend("iptables"));
+    CPPUNIT_ASSERT_EQUAL(Firewall_backend::nftables,
+                         parse_firewall_backend("nftables"));
+    CPPUNIT_ASSERT_THROW((void)parse_firewall_backend("ipfw"),
+                         std::invalid_argument);
+
+    auto const iptables =
+        firewall_transaction(Firewall_backend::iptables, {});
+    CPPUNIT_ASSERT(iptables.target<Firewall_transaction>() != nullptr);
+    auto const nftables =
+        firewall_transaction(Firewall_backend::nftables, {});
+    CPPUNIT_ASSERT(nftables.target<Nft_transaction>() != nullptr);
+  }
+
   static void test_take_action() {
     const std::string filename{"/tmp/take_action_test_testfile"};
     CPPUNIT_ASSERT(!file_exists(filename));
@@ -21,6 +21,7 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <cstring>
+#include <net/if_arp.h>
 #include <netinet/in.h>
 #include <string>
 #include <sys/socket.h>
@@ -75,6 +76,7 @@ class Socket_test : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_ioctl_throws);
   CPPUNIT_TEST(test_send_to);
   //  CPPUNIT_TEST(test_get_ifindex);
+  CPPUNIT_TEST(test_get_hwtype);
   CPPUNIT_TEST(test_set_sock_opt);
   CPPUNIT_TEST(test_destructor);
   CPPUNIT_TEST_SUITE_END();
@@ -150,6 +152,14 @@ public:
     CPPUNIT_ASSERT_THROW((void)s0.get_ifindex("eth0"), std::runtime_error);
   }
 
+  static void test_get_hwtype() {
+    Socket s0(AF_INET, SOCK_DGRAM);
+
+    CPPUNIT_ASSERT_EQUAL(uint16_t{ARPHRD_LOOPBACK}, s0.get_hwtype("lo"));
+    CPPUNIT_ASSERT_THROW((void)s0.get_hwtype("doesnotexist"),
+                         std::runtime_error);
+  }
+
   static void test_set_sock_opt() {
     Socket_listen sock(AF_INET, SOCK_DGRAM);
     CPPUNIT_ASSERT_EQUAL(0, sock.get_sock_opt<int>(SOL_SOCKET, SO_BROADCAST));
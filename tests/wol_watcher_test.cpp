@@ -21,6 +21,7 @@
 
 #include <cppunit/extensions/HelperMacros.h>
 #include <limits>
+#include <memory>
 #include <random>
 
 namespace {
@@ -42,6 +43,49 @@ pcap_pkthdr create_header(size_t packet_length) {
                                   .len = static_cast<uint32_t>(packet_length)};
   return header;
 }
+
+// broadcast from 02:00:00:00:00:01
+const std::string ethernet_header = "ffffffffffff020000000001";
+// linux cooked capture, broadcast from 02:00:00:00:00:01
+const std::string lcc_header = "000100010006020000000001";
+// 192.168.0.2 -> 192.168.0.255, UDP
+const std::string ipv4_header =
+    "0800450000000001000040110000c0a80002c0a800ff";
+// same with a 4 byte no operation option
+const std::string ipv4_options_header =
+    "0800460000000001000040110000c0a80002c0a800ff01010100";
+// fe80::1 -> ff02::1, UDP
+const std::string ipv6_header = "86dd6000000000001140"
+                                "fe800000000000000000000000000001"
+                                "ff020000000000000000000000000001";
+// 192.168.0.2 -> 192.168.0.255, TCP
+const std::string ipv4_tcp_header =
+    "0800450000000001000040060000c0a80002c0a800ff";
+
+std::string udp_header(std::string const &port) {
+  return "c350" + port + "00000000";
+}
+
+/** counts how many frames pass filter, like the kernel would */
+size_t count_delivered(int const datalink, std::string const &filter,
+                       std::vector<std::vector<uint8_t>> const &frames) {
+  std::unique_ptr<pcap_t, void (*)(pcap_t *)> const dead{
+      pcap_open_dead(datalink, Pcap_wrapper::default_snaplen), pcap_close};
+  bpf_program bpf{.bf_len = 0, .bf_insns = nullptr};
+  CPPUNIT_ASSERT_EQUAL(0, pcap_compile(dead.get(), &bpf, filter.c_str(), 1,
+                                       PCAP_NETMASK_UNKNOWN));
+  size_t delivered = 0;
+  for (auto const &frame : frames) {
+    auto const size = static_cast<uint32_t>(frame.size());
+    pcap_pkthdr const header{
+        .ts = {.tv_sec = 0, .tv_usec = 0}, .caplen = size, .len = size};
+    if (pcap_offline_filter(&bpf, &header, frame.data()) != 0) {
+      delivered++;
+    }
+  }
+  pcap_freecode(&bpf);
+  return delivered;
+}
 } // namespace
 
 class Wol_watcher_test : public CppUnit::TestFixture {
@@ -49,6 +93,9 @@ class Wol_watcher_test : public CppUnit::TestFixture {
   CPPUNIT_TEST(test_is_magic_packet);
   CPPUNIT_TEST(test_break_on_magic_packet);
   CPPUNIT_TEST(test_wol_watcher_thread_main);
+  CPPUNIT_TEST(test_get_wol_filter);
+  CPPUNIT_TEST(test_wol_filter_replay);
+  CPPUNIT_TEST(test_wol_filter_replay_lcc);
   CPPUNIT_TEST_SUITE_END();
 
   ether_addr const mac0 = mac_to_binary("01:45:12:78:af:bd");
@@ -140,6 +187,83 @@ public:
     CPPUNIT_ASSERT(Pcap_wrapper::Loop_end_reason::duplicate_address ==
                    wait_on_syn.get_end_reason());
   }
+
+  void test_get_wol_filter() {
+    CPPUNIT_ASSERT_EQUAL(get_wol_filter(), get_wol_filter({}, DLT_EN10MB));
+
+    auto const filter = get_wol_filter({mac0, mac1}, DLT_EN10MB);
+    CPPUNIT_ASSERT(filter.find("udp[14:4] = 0x01451278 and "
+                               "udp[18:2] = 0xafbd") != std::string::npos);
+    CPPUNIT_ASSERT(filter.find("ip6[54:4] = 0x3312abde and "
+                               "ip6[58:2] = 0x5681") != std::string::npos);
+    CPPUNIT_ASSERT(filter.find("link[20:4] = 0x01451278") !=
+                   std::string::npos);
+    CPPUNIT_ASSERT(get_wol_filter({mac0}, DLT_LINUX_SLL)
+                       .find("link[22:4] = 0x01451278") != std::string::npos);
+
+    // no idea where the ethernet payload starts
+    CPPUNIT_ASSERT(get_wol_filter({mac0}, DLT_RAW).find("link[") ==
+                   std::string::npos);
+  }
+
+  void test_wol_filter_replay() {
+    auto const magic0 = create_wol_payload(mac0);
+    auto const magic1 = create_wol_payload(mac1);
+    // NOLINTNEXTLINE
+    auto const chatter = gen_random_data(120);
+    auto const eth = [](std::string const &headers) {
+      return to_binary(ethernet_header + headers);
+    };
+    std::vector<std::vector<uint8_t>> const frames{
+        // magic packets for mac0 in every encapsulation
+        eth(ipv4_header + udp_header("0009")) + magic0,
+        eth(ipv4_options_header + udp_header("0007")) + magic0,
+        eth(ipv6_header + udp_header("0009")) + magic0,
+        eth("0842") + magic0,
+        // magic packets for someone else
+        eth(ipv4_header + udp_header("0009")) + magic1,
+        eth(ipv6_header + udp_header("0000")) + magic1,
+        eth("0842") + magic1,
+        // other traffic on the WOL ports
+        eth(ipv4_header + udp_header("0009")) + chatter,
+        eth(ipv4_header + udp_header("0007")) + chatter,
+        eth(ipv6_header + udp_header("0009")) + chatter,
+        // magic packet not right at the start of the payload
+        eth(ipv4_header + udp_header("0009")) + chatter + magic0,
+        // unrelated
+        eth(ipv4_tcp_header + udp_header("0016")) + magic0};
+
+    CPPUNIT_ASSERT_EQUAL(size_t{11},
+                         count_delivered(DLT_EN10MB, get_wol_filter(), frames));
+    CPPUNIT_ASSERT_EQUAL(
+        size_t{4},
+        count_delivered(DLT_EN10MB, get_wol_filter({mac0}, DLT_EN10MB),
+                        frames));
+    CPPUNIT_ASSERT_EQUAL(
+        size_t{7}, count_delivered(DLT_EN10MB,
+                                   get_wol_filter({mac0, mac1}, DLT_EN10MB),
+                                   frames));
+  }
+
+  void test_wol_filter_replay_lcc() {
+    auto const magic0 = create_wol_payload(mac0);
+    auto const magic1 = create_wol_payload(mac1);
+    auto const lcc = [](std::string const &headers) {
+      return to_binary(lcc_header + "0000" + headers);
+    };
+    std::vector<std::vector<uint8_t>> const frames{
+        lcc(ipv4_header + udp_header("0009")) + magic0,
+        lcc("0842") + magic0,
+        lcc(ipv6_header + udp_header("0009")) + magic1,
+        lcc("0842") + magic1};
+
+    CPPUNIT_ASSERT_EQUAL(
+        size_t{4}, count_delivered(DLT_LINUX_SLL, get_wol_filter(), frames));
+    CPPUNIT_ASSERT_EQUAL(
+        size_t{2},
+        count_delivered(DLT_LINUX_SLL, get_wol_filter({mac0}, DLT_LINUX_SLL),
+                        frames));
+  }
 };
 
 CPPUNIT_TEST_SUITE_REGISTRATION(Wol_watcher_test);